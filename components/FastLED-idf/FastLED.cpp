@@ -1,6 +1,14 @@
 #define FASTLED_INTERNAL
 #include "FastLED.h"
 
+#if defined(ESP32)
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#elif defined(FASTLED_HOST)
+#include <time.h>
+#endif
+
 
 #if defined(__SAM3X8E__)
 volatile uint32_t fuckit;
@@ -19,6 +27,49 @@ static uint32_t lastshow = 0;
 uint32_t _frame_cnt=0;
 uint32_t _retry_cnt=0;
 
+// Sleep for about the given number of microseconds, letting other tasks run.  May come back a
+// little late (the frame pacer spins the rest of the way), never early.
+#if defined(ESP32)
+static esp_timer_handle_t gPacerTimer = NULL;
+static SemaphoreHandle_t gPacerSem = NULL;
+static bool gPacerFailed = false;	// no timer to be had; the pacer just spins
+
+static void pacerWake(void *arg) {
+	xSemaphoreGive(gPacerSem);
+}
+
+static void pacerSleep(uint32_t us) {
+	if(gPacerTimer == NULL) {
+		if(gPacerFailed) { return; }
+		esp_timer_create_args_t args = {};
+		args.callback = pacerWake;
+		args.arg = NULL;
+		args.dispatch_method = ESP_TIMER_TASK;
+		args.name = "fastled_pacer";
+		gPacerSem = xSemaphoreCreateBinary();
+		if(gPacerSem == NULL || esp_timer_create(&args, &gPacerTimer) != ESP_OK) {
+			if(gPacerSem != NULL) { vSemaphoreDelete(gPacerSem); }
+			gPacerSem = NULL;
+			gPacerTimer = NULL;
+			gPacerFailed = true;
+			return;
+		}
+	}
+	if(esp_timer_start_once(gPacerTimer, us) == ESP_OK) {
+		xSemaphoreTake(gPacerSem, portMAX_DELAY);
+	}
+}
+#elif defined(FASTLED_HOST)
+static void pacerSleep(uint32_t us) {
+	struct timespec ts;
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (us % 1000000) * 1000L;
+	nanosleep(&ts, NULL);
+}
+#else
+static void pacerSleep(uint32_t us) { }
+#endif
+
 // uint32_t CRGB::Squant = ((uint32_t)((__TIME__[4]-'0') * 28))<<16 | ((__TIME__[6]-'0')*50)<<8 | ((__TIME__[7]-'0')*28);
 
 CFastLED::CFastLED() {
@@ -28,6 +79,9 @@ CFastLED::CFastLED() {
 	m_nFPS = 0;
 	m_pPowerFunc = NULL;
 	m_nPowerData = 0xFFFFFFFF;
+	m_Stats.reset();
+	m_nStatsSeq = 0;
+	m_nStatsBase[0] = m_nStatsBase[1] = m_nStatsBase[2] = 0;
 }
 
 CLEDController &CFastLED::addLeds(CLEDController *pLed,
@@ -42,9 +96,36 @@ CLEDController &CFastLED::addLeds(CLEDController *pLed,
 	return *pLed;
 }
 
+CLEDController &CFastLED::addLeds(CLEDController *pLed,
+									   struct CRGB16 *data,
+									   int nLedsOrOffset, int nLedsIfOffset) {
+	int nOffset = (nLedsIfOffset > 0) ? nLedsOrOffset : 0;
+	int nLeds = (nLedsIfOffset > 0) ? nLedsIfOffset : nLedsOrOffset;
+
+	pLed->init();
+	pLed->setLeds(data + nOffset, nLeds);
+	FastLED.setMaxRefreshRate(pLed->getMaxRefreshRate(),true);
+	return *pLed;
+}
+
+CLEDController &CFastLED::addLeds(CLEDController *pLed,
+									   struct CRGBW *data,
+									   int nLedsOrOffset, int nLedsIfOffset) {
+	int nOffset = (nLedsIfOffset > 0) ? nLedsOrOffset : 0;
+	int nLeds = (nLedsIfOffset > 0) ? nLedsIfOffset : nLedsOrOffset;
+
+	pLed->init();
+	pLed->setLeds(data + nOffset, nLeds);
+	FastLED.setMaxRefreshRate(pLed->getMaxRefreshRate(),true);
+	return *pLed;
+}
+
 void CFastLED::show(uint8_t scale) {
 	// guard against showing too rapidly
-	while(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros));
+#if (FASTLED_STATS == 1)
+	uint32_t prevshow = lastshow;
+#endif
+	waitForNextShow();
 	lastshow = micros();
 
 	// If we have a function for computing power, use it!
@@ -52,17 +133,125 @@ void CFastLED::show(uint8_t scale) {
 		scale = (*m_pPowerFunc)(scale, m_nPowerData);
 	}
 
+#if (FASTLED_STATS == 1)
+	uint32_t controllerShow[FASTLED_STATS_MAX_CONTROLLERS];
+#endif
+	int nControllers = 0;
 	CLEDController *pCur = CLEDController::head();
 	while(pCur) {
 		uint8_t d = pCur->getDither();
 		if(m_nFPS < 100) { pCur->setDither(0); }
+#if (FASTLED_STATS == 1)
+		uint32_t start = micros();
+		pCur->showLeds(scale);
+		if(nControllers < FASTLED_STATS_MAX_CONTROLLERS) { controllerShow[nControllers] = micros() - start; }
+#else
 		pCur->showLeds(scale);
+#endif
 		pCur->setDither(d);
 		pCur = pCur->next();
+		nControllers++;
 	}
+	// the power sums taken for this frame are spent
+	power_mgt_frame_done();
 	countFPS();
+#if (FASTLED_STATS == 1)
+	updateStats(lastshow, lastshow - prevshow, controllerShow, nControllers);
+#endif
 }
 
+#ifdef FASTLED_HAS_ASYNC_SHOW
+// RMT bailouts, retries and skips, summed over all the RMT controllers
+static void getRMTCounters(uint32_t counters[3]) {
+	counters[0] = counters[1] = counters[2] = 0;
+	for(int i = 0; i < ESP32RMTController::getNumControllers(); i++) {
+		ESP32RMTController *pController = ESP32RMTController::getController(i);
+		counters[0] += pController->getBailouts();
+		counters[1] += pController->getRetries();
+		counters[2] += pController->getSkips();
+	}
+}
+#endif
+
+// Record one frame.  Readers in other tasks copy m_Stats while m_nStatsSeq is even and
+// unchanged across the copy (see getStats()).
+void CFastLED::updateStats(uint32_t showStart, uint32_t interval, const uint32_t *controllerShow, int nControllers) {
+	uint32_t total = micros() - showStart;
+	uint32_t wire = 0;
+	bool waited = false;
+	bool pipelined = false;
+#ifdef FASTLED_HAS_ASYNC_SHOW
+	wire = ESP32RMTController::getActualMakespan();
+	waited = ! ESP32RMTController::isAsync();
+	pipelined = FASTLED_RMT_PIPELINE_ACTIVE;
+	uint32_t counters[3];
+	getRMTCounters(counters);
+#endif
+
+	m_nStatsSeq++;
+	__sync_synchronize();
+
+	if(m_Stats.frames) { m_Stats.interval.add(interval); }
+	m_Stats.show.add(total);
+	// a synchronous show waits for the wire; an asynchronous one returns once it starts.  A
+	// pipelined one sends while it encodes, so there is no telling the two apart.
+	if(!pipelined) {
+		uint32_t encode = total;
+		if(waited) { encode = (total > wire) ? total - wire : 0; }
+		m_Stats.encode.add(encode);
+	}
+	m_Stats.wire.add(wire);
+	for(int i = 0; i < nControllers && i < FASTLED_STATS_MAX_CONTROLLERS; i++) {
+		m_Stats.controllerShow[i] = controllerShow[i];
+	}
+#ifdef FASTLED_HAS_ASYNC_SHOW
+	for(int i = 0; i < ESP32RMTController::getNumControllers() && i < FASTLED_STATS_MAX_CONTROLLERS; i++) {
+		m_Stats.controllerTransmit[i] = ESP32RMTController::getController(i)->getTransmitTime();
+	}
+	m_Stats.bailouts = counters[0] - m_nStatsBase[0];
+	m_Stats.retries = counters[1] - m_nStatsBase[1];
+	m_Stats.dropped = m_Stats.bailouts - m_Stats.retries;
+	m_Stats.skipped = counters[2] - m_nStatsBase[2];
+#endif
+	m_Stats.frames++;
+
+	__sync_synchronize();
+	m_nStatsSeq++;
+}
+
+void CFastLED::getStats(CFastLEDStats & stats) {
+	uint32_t seq;
+	do {
+		seq = m_nStatsSeq;
+		__sync_synchronize();
+		stats = m_Stats;
+		__sync_synchronize();
+	} while((seq & 1) || (seq != m_nStatsSeq));
+}
+
+void CFastLED::resetStats() {
+	m_nStatsSeq++;
+	__sync_synchronize();
+	m_Stats.reset();
+#ifdef FASTLED_HAS_ASYNC_SHOW
+	getRMTCounters(m_nStatsBase);
+#endif
+	__sync_synchronize();
+	m_nStatsSeq++;
+}
+
+#ifdef FASTLED_HAS_ASYNC_SHOW
+void CFastLED::showAsync(uint8_t scale) {
+	ESP32RMTController::setAsync(true);
+	show(scale);
+	ESP32RMTController::setAsync(false);
+}
+
+void CFastLED::waitForShow() {
+	ESP32RMTController::waitForShow();
+}
+#endif
+
 int CFastLED::count() {
     int x = 0;
 	CLEDController *pCur = CLEDController::head();
@@ -86,7 +275,7 @@ CLEDController & CFastLED::operator[](int x) {
 }
 
 void CFastLED::showColor(const struct CRGB & color, uint8_t scale) {
-	while(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros));
+	waitForNextShow();
 	lastshow = micros();
 
 	// If we have a function for computing power, use it!
@@ -102,6 +291,7 @@ void CFastLED::showColor(const struct CRGB & color, uint8_t scale) {
 		pCur->setDither(d);
 		pCur = pCur->next();
 	}
+	power_mgt_frame_done();
 	countFPS();
 }
 
@@ -118,6 +308,7 @@ void CFastLED::clearData() {
 		pCur->clearLedData();
 		pCur = pCur->next();
 	}
+	power_mgt_frame_done();
 }
 
 void CFastLED::delay(unsigned long ms) {
@@ -203,6 +394,22 @@ void CFastLED::setDither(uint8_t ditherMode)  {
 extern int noise_min;
 extern int noise_max;
 
+uint32_t CFastLED::microsUntilNextShow() {
+	uint32_t elapsed = micros() - lastshow;
+	return (elapsed < m_nMinMicros) ? (m_nMinMicros - elapsed) : 0;
+}
+
+// Sleep through most of the time left, then spin the last FASTLED_PACER_SPIN_US, which
+// covers the wake-up latency of the sleep
+void CFastLED::waitForNextShow() {
+	uint32_t left;
+	while((left = microsUntilNextShow()) != 0) {
+		if(left > FASTLED_PACER_SPIN_US) {
+			pacerSleep(left - FASTLED_PACER_SPIN_US);
+		}
+	}
+}
+
 void CFastLED::countFPS(int nFrames) {
   static int br = 0;
   static uint32_t lastframe = 0; // millis();
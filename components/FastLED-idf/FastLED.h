@@ -4,6 +4,11 @@
 ///@file FastLED.h
 /// central include file for FastLED, defines the CFastLED class/object
 
+#ifdef FASTLED_HOST
+// Host (Linux) build, see platforms/host
+#define FASTLED_NO_PINMAP
+#else
+
 // BB hack
 #define ESP32
 #define FASTLED_NO_PINMAP
@@ -13,6 +18,7 @@
 #define FASTLED_ESP32_I2S
 
 #include "esp32-hal.h"
+#endif
 
 #if (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 4)
 #define FASTLED_HAS_PRAGMA_MESSAGE
@@ -73,6 +79,7 @@
 
 #include "noise.h"
 #include "power_mgt.h"
+#include "fastled_stats.h"
 
 #include "fastspi.h"
 #include "chipsets.h"
@@ -194,6 +201,12 @@ class CFastLED {
 	uint32_t m_nMinMicros;		///< minimum µs between frames, used for capping frame rates.
 	uint32_t m_nPowerData;		///< max power use parameter
 	power_func m_pPowerFunc;	///< function for overriding brightness when using FastLED.show();
+	CFastLEDStats m_Stats;		///< frame timing statistics, see getStats()
+	volatile uint32_t m_nStatsSeq;	///< odd while m_Stats is being updated
+	uint32_t m_nStatsBase[3];	///< RMT bailouts, retries and skips at the last resetStats()
+
+	void updateStats(uint32_t showStart, uint32_t interval, const uint32_t *controllerShow, int nControllers);
+	void waitForNextShow();
 
 public:
 	CFastLED();
@@ -212,6 +225,13 @@ public:
 	/// @returns a reference to the added controller
 	static CLEDController &addLeds(CLEDController *pLed, struct CRGB *data, int nLedsOrOffset, int nLedsIfOffset = 0);
 
+	/// Add a CLEDController instance driven from 16-bit led data, which it temporally dithers
+	/// down to 8 bits.  Arguments as above.
+	static CLEDController &addLeds(CLEDController *pLed, struct CRGB16 *data, int nLedsOrOffset, int nLedsIfOffset = 0);
+
+	/// Add a CLEDController instance driven from 4-byte rgbw led data (see CRGBW).  Arguments as above.
+	static CLEDController &addLeds(CLEDController *pLed, struct CRGBW *data, int nLedsOrOffset, int nLedsIfOffset = 0);
+
 	/// @name Adding SPI based controllers
   //@{
 	/// Add an SPI based  CLEDController instance to the world.
@@ -327,6 +347,44 @@ public:
 		return addLeds(&c, data, nLedsOrOffset, nLedsIfOffset);
 	}
 
+	/// The same, driven from 16-bit led data (see CRGB16)
+	template<template<uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+	static CLEDController &addLeds(struct CRGB16 *data, int nLedsOrOffset, int nLedsIfOffset = 0) {
+		static CHIPSET<DATA_PIN, RGB_ORDER> c;
+		return addLeds(&c, data, nLedsOrOffset, nLedsIfOffset);
+	}
+
+	template<template<uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN>
+	static CLEDController &addLeds(struct CRGB16 *data, int nLedsOrOffset, int nLedsIfOffset = 0) {
+		static CHIPSET<DATA_PIN, RGB> c;
+		return addLeds(&c, data, nLedsOrOffset, nLedsIfOffset);
+	}
+
+	template<template<uint8_t DATA_PIN> class CHIPSET, uint8_t DATA_PIN>
+	static CLEDController &addLeds(struct CRGB16 *data, int nLedsOrOffset, int nLedsIfOffset = 0) {
+		static CHIPSET<DATA_PIN> c;
+		return addLeds(&c, data, nLedsOrOffset, nLedsIfOffset);
+	}
+
+	/// The same, driven from 4-byte rgbw led data (see CRGBW)
+	template<template<uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+	static CLEDController &addLeds(struct CRGBW *data, int nLedsOrOffset, int nLedsIfOffset = 0) {
+		static CHIPSET<DATA_PIN, RGB_ORDER> c;
+		return addLeds(&c, data, nLedsOrOffset, nLedsIfOffset);
+	}
+
+	template<template<uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN>
+	static CLEDController &addLeds(struct CRGBW *data, int nLedsOrOffset, int nLedsIfOffset = 0) {
+		static CHIPSET<DATA_PIN, RGB> c;
+		return addLeds(&c, data, nLedsOrOffset, nLedsIfOffset);
+	}
+
+	template<template<uint8_t DATA_PIN> class CHIPSET, uint8_t DATA_PIN>
+	static CLEDController &addLeds(struct CRGBW *data, int nLedsOrOffset, int nLedsIfOffset = 0) {
+		static CHIPSET<DATA_PIN> c;
+		return addLeds(&c, data, nLedsOrOffset, nLedsIfOffset);
+	}
+
 #if defined(__FASTLED_HAS_FIBCC) && (__FASTLED_HAS_FIBCC == 1)
   template<uint8_t NUM_LANES, template<uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER=RGB>
   static CLEDController &addLeds(struct CRGB *data, int nLeds) {
@@ -502,7 +560,7 @@ public:
 
 	/// Set the maximum power to be used, given in milliwatts
 	/// @param milliwatts - the max power draw desired, in milliwatts
-	inline void setMaxPowerInMilliWatts(uint32_t milliwatts) { m_pPowerFunc = &calculate_max_brightness_for_power_mW; m_nPowerData = milliwatts; }
+	inline void setMaxPowerInMilliWatts(uint32_t milliwatts) { m_pPowerFunc = &show_max_brightness_for_power_mW; m_nPowerData = milliwatts; }
 
 	/// Update all our controllers with the current led colors, using the passed in brightness
 	/// @param scale temporarily override the scale
@@ -511,6 +569,21 @@ public:
 	/// Update all our controllers with the current led colors
 	void show() { show(m_Scale); }
 
+#ifdef FASTLED_HAS_ASYNC_SHOW
+	/// Update all our controllers with the current led colors, using the passed in brightness,
+	/// but return as soon as the data has been handed to the hardware instead of waiting for
+	/// it to be sent.  The led arrays may be modified as soon as this returns.
+	/// @param scale temporarily override the scale
+	void showAsync(uint8_t scale);
+
+	/// Update all our controllers with the current led colors without waiting for the
+	/// data to be sent
+	void showAsync() { showAsync(m_Scale); }
+
+	/// Wait until the data from the last showAsync() has been sent out to the leds
+	void waitForShow();
+#endif
+
 	/// clear the leds, wiping the local array of data, optionally black out the leds as well
 	/// @param writeData whether or not to write out to the leds as well
 	void clear(bool writeData = false);
@@ -557,6 +630,12 @@ public:
 	/// @param constrain - constrain refresh rate to the slowest speed yet set
 	void setMaxRefreshRate(uint16_t refresh, bool constrain=false);
 
+	/// How long until show() can send the next frame without waiting for the refresh rate cap.
+	/// show() sleeps the calling task for most of that time, rather than spinning, but a caller
+	/// can also use it to do other work first.
+	/// @returns microseconds left, 0 if a frame can be shown now
+	uint32_t microsUntilNextShow();
+
 	/// for debugging, will keep track of time between calls to countFPS, and every
 	/// nFrames calls, it will update an internal counter for the current FPS.
 	/// @todo make this a rolling counter
@@ -567,6 +646,15 @@ public:
 	/// @returns the most recently computed FPS value
 	uint16_t getFPS() { return m_nFPS; }
 
+	/// Get a consistent copy of the frame timing statistics kept by show() (see
+	/// CFastLEDStats).  Safe to call from any task, even while another one is showing.
+	/// All zero unless FASTLED_STATS is set.
+	/// @param stats - where to copy them
+	void getStats(CFastLEDStats & stats);
+
+	/// Start the statistics over.  Call it from the task that shows, or while nothing is showing.
+	void resetStats();
+
 	/// Get how many controllers have been registered
   /// @returns the number of controllers (strips) that have been added with addLeds
 	int count();
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <math.h>
+#include <string.h>
 
 #include "FastLED.h"
 
@@ -26,6 +27,14 @@ void fill_solid( struct CHSV * targetArray, int numToFill,
     }
 }
 
+void fill_solid( struct CRGBW * leds, int numToFill,
+                 const struct CRGBW& color)
+{
+    for( int i = 0; i < numToFill; i++) {
+        leds[i].raw32 = color.raw32;
+    }
+}
+
 
 // void fill_solid( struct CRGB* targetArray, int numToFill,
 // 				 const struct CHSV& hsvColor)
@@ -169,11 +178,89 @@ void fill_gradient_RGB( CRGB* leds, uint16_t numLeds, const CRGB& c1, const CRGB
 
 
 
+#if (FASTLED_COLORUTILS_SWAR == 1) && (SCALE8_C == 1)
+#define SWAR_COLORUTILS 1
+
+// The bulk functions below treat the led array as a run of bytes that all
+// get the same treatment, so they can work on whole words: the even and the
+// odd bytes of a word are spread into two 16-bit lanes each, one multiply
+// scales both lanes, and the top bytes of the lanes are put back together.
+// Bytes before the first aligned word and after the last are done one at a
+// time, the same way.
+typedef uint32_t __attribute__((__may_alias__)) swar_word_t;
+
+#define SWAR_LANES 0x00FF00FFu
+
+// scale8 of each byte of w, mul being scale (+1 with FASTLED_SCALE8_FIXED)
+static inline uint32_t swar_scale8( uint32_t w, uint16_t mul)
+{
+    uint32_t even = ((w & SWAR_LANES) * mul) >> 8;
+    uint32_t odd  = ((w >> 8) & SWAR_LANES) * mul;
+    return (even & SWAR_LANES) | (odd & ~SWAR_LANES);
+}
+
+// scale8_video of each byte of w; nz is 1 if scale is not 0, else 0
+static inline uint32_t swar_scale8_video( uint32_t w, uint8_t scale, uint32_t nz)
+{
+    uint32_t even = w & SWAR_LANES;
+    uint32_t odd  = (w >> 8) & SWAR_LANES;
+    // each lane gets one more if it is not zero
+    uint32_t evenNZ = ((even + SWAR_LANES) >> 8) & (0x00010001u * nz);
+    uint32_t oddNZ  = ((odd  + SWAR_LANES) >> 8) & (0x00010001u * nz);
+    even = (((even * scale) >> 8) & SWAR_LANES) + evenNZ;
+    odd  = (((odd  * scale) >> 8) & SWAR_LANES) + oddNZ;
+    return even | (odd << 8);
+}
+
+#if (FASTLED_BLEND_FIXED == 1)
+// the weights blend8 gives a and b: 256 - amountOfB and amountOfB + 1
+// with FASTLED_SCALE8_FIXED, else 255 - amountOfB and amountOfB
+static inline void swar_blend_weights( uint8_t amountOfB, uint16_t& mulA, uint16_t& mulB)
+{
+#if (FASTLED_SCALE8_FIXED == 1)
+    mulA = 256 - amountOfB;
+    mulB = (uint16_t)amountOfB + 1;
+#else
+    mulA = 255 - amountOfB;
+    mulB = amountOfB;
+#endif
+}
+
+// blend8 of each byte of a toward each byte of b, with the weights from
+// swar_blend_weights: (a * mulA + b * mulB) >> 8, which fits a lane
+static inline uint32_t swar_blend8( uint32_t a, uint32_t b, uint16_t mulA, uint16_t mulB)
+{
+    uint32_t even = ((a & SWAR_LANES) * mulA + (b & SWAR_LANES) * mulB) >> 8;
+    uint32_t odd  = ((a >> 8) & SWAR_LANES) * mulA + ((b >> 8) & SWAR_LANES) * mulB;
+    return (even & SWAR_LANES) | (odd & ~SWAR_LANES);
+}
+#endif
+#endif
+
 void nscale8_video( CRGB* leds, uint16_t num_leds, uint8_t scale)
 {
+#ifdef SWAR_COLORUTILS
+    uint8_t* p = (uint8_t*)leds;
+    uint32_t n = (uint32_t)num_leds * 3;
+    uint32_t nz = (scale != 0) ? 1 : 0;
+
+    while( n && ((uintptr_t)p & 3)) {
+        *p = scale8_video( *p, scale);
+        p++; n--;
+    }
+    for( ; n >= 4; n -= 4, p += 4) {
+        swar_word_t* w = (swar_word_t*)p;
+        *w = swar_scale8_video( *w, scale, nz);
+    }
+    while( n) {
+        *p = scale8_video( *p, scale);
+        p++; n--;
+    }
+#else
     for( uint16_t i = 0; i < num_leds; i++) {
         leds[i].nscale8_video( scale);
     }
+#endif
 }
 
 void fade_video(CRGB* leds, uint16_t num_leds, uint8_t fadeBy)
@@ -202,6 +289,8 @@ void nscale8_raw( CRGB* leds, uint16_t num_leds, uint8_t scale)
     nscale8( leds, num_leds, scale);
 }
 
+// a led at a time even with SWAR_COLORUTILS: the plain loop measures
+// faster than the SWAR one in colorutils_bench
 void nscale8( CRGB* leds, uint16_t num_leds, uint8_t scale)
 {
     for( uint16_t i = 0; i < num_leds; i++) {
@@ -261,11 +350,147 @@ CRGB& nblend( CRGB& existing, const CRGB& overlay, fract8 amountOfOverlay )
 
 void nblend( CRGB* existing, CRGB* overlay, uint16_t count, fract8 amountOfOverlay)
 {
+#if defined(SWAR_COLORUTILS) && (FASTLED_BLEND_FIXED == 1)
+    if( amountOfOverlay == 0) {
+        return;
+    }
+
+    if( amountOfOverlay == 255) {
+        for( uint16_t i = 0; i < count; i++) {
+            existing[i] = overlay[i];
+        }
+        return;
+    }
+
+    uint8_t* p = (uint8_t*)existing;
+    const uint8_t* q = (const uint8_t*)overlay;
+    uint32_t n = (uint32_t)count * 3;
+    uint16_t mulA, mulB;
+    swar_blend_weights( amountOfOverlay, mulA, mulB);
+
+    while( n && ((uintptr_t)p & 3)) {
+        *p = blend8( *p, *q++, amountOfOverlay);
+        p++; n--;
+    }
+    // the overlay may not line up with existing, so it is read with memcpy
+    for( ; n >= 4; n -= 4, p += 4, q += 4) {
+        swar_word_t* w = (swar_word_t*)p;
+        uint32_t o;
+        memcpy( &o, q, 4);
+        *w = swar_blend8( *w, o, mulA, mulB);
+    }
+    while( n) {
+        *p = blend8( *p, *q++, amountOfOverlay);
+        p++; n--;
+    }
+#else
     for( uint16_t i = count; i; i--) {
         nblend( *existing, *overlay, amountOfOverlay);
         existing++;
         overlay++;
     }
+#endif
+}
+
+
+// CRGBW pixels are whole aligned words, so there are no odd bytes at
+// either end to take care of
+
+void nscale8_video( CRGBW* leds, uint16_t num_leds, uint8_t scale)
+{
+#ifdef SWAR_COLORUTILS
+    uint32_t nz = (scale != 0) ? 1 : 0;
+    for( uint16_t i = 0; i < num_leds; i++) {
+        leds[i].raw32 = swar_scale8_video( leds[i].raw32, scale, nz);
+    }
+#else
+    for( uint16_t i = 0; i < num_leds; i++) {
+        leds[i].nscale8_video( scale);
+    }
+#endif
+}
+
+void fade_video( CRGBW* leds, uint16_t num_leds, uint8_t fadeBy)
+{
+    nscale8_video( leds, num_leds, 255 - fadeBy);
+}
+
+void fadeLightBy( CRGBW* leds, uint16_t num_leds, uint8_t fadeBy)
+{
+    nscale8_video( leds, num_leds, 255 - fadeBy);
+}
+
+void nscale8( CRGBW* leds, uint16_t num_leds, uint8_t scale)
+{
+#ifdef SWAR_COLORUTILS
+#if (FASTLED_SCALE8_FIXED == 1)
+    uint16_t mul = (uint16_t)scale + 1;
+#else
+    uint16_t mul = scale;
+#endif
+    for( uint16_t i = 0; i < num_leds; i++) {
+        leds[i].raw32 = swar_scale8( leds[i].raw32, mul);
+    }
+#else
+    for( uint16_t i = 0; i < num_leds; i++) {
+        leds[i].nscale8( scale);
+    }
+#endif
+}
+
+void fadeToBlackBy( CRGBW* leds, uint16_t num_leds, uint8_t fadeBy)
+{
+    nscale8( leds, num_leds, 255 - fadeBy);
+}
+
+void fade_raw( CRGBW* leds, uint16_t num_leds, uint8_t fadeBy)
+{
+    nscale8( leds, num_leds, 255 - fadeBy);
+}
+
+CRGBW& nblend( CRGBW& existing, const CRGBW& overlay, fract8 amountOfOverlay )
+{
+    if( amountOfOverlay == 0) {
+        return existing;
+    }
+
+    if( amountOfOverlay == 255) {
+        existing = overlay;
+        return existing;
+    }
+
+    existing.r = blend8( existing.r, overlay.r, amountOfOverlay);
+    existing.g = blend8( existing.g, overlay.g, amountOfOverlay);
+    existing.b = blend8( existing.b, overlay.b, amountOfOverlay);
+    existing.w = blend8( existing.w, overlay.w, amountOfOverlay);
+
+    return existing;
+}
+
+void nblend( CRGBW* existing, CRGBW* overlay, uint16_t count, fract8 amountOfOverlay)
+{
+#if defined(SWAR_COLORUTILS) && (FASTLED_BLEND_FIXED == 1)
+    if( amountOfOverlay == 0) {
+        return;
+    }
+
+    if( amountOfOverlay == 255) {
+        for( uint16_t i = 0; i < count; i++) {
+            existing[i] = overlay[i];
+        }
+        return;
+    }
+
+    uint16_t mulA, mulB;
+    swar_blend_weights( amountOfOverlay, mulA, mulB);
+    for( uint16_t i = 0; i < count; i++) {
+        existing[i].raw32 = swar_blend8( existing[i].raw32, overlay[i].raw32, mulA, mulB);
+    }
+#else
+    for( uint16_t i = 0; i < count; i++) {
+        nblend( existing[i], overlay[i], amountOfOverlay);
+    }
+#endif
 }
 
 CRGB blend( const CRGB& p1, const CRGB& p2, fract8 amountOfP2 )
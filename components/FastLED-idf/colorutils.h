@@ -23,6 +23,11 @@ void fill_solid( struct CRGB * leds, int numToFill,
 void fill_solid( struct CHSV* targetArray, int numToFill,
 				 const struct CHSV& hsvColor);
 
+/// fill_solid -   fill a range of LEDs with a solid color
+///                Example: fill_solid( leds, NUM_LEDS, CRGBW(50,0,200,10));
+void fill_solid( struct CRGBW * leds, int numToFill,
+                 const struct CRGBW& color);
+
 
 /// fill_rainbow - fill a range of LEDs with a rainbow of colors, at
 ///                full saturation and full value (brightness)
@@ -267,6 +272,15 @@ void nscale8(       CRGB* leds, uint16_t num_leds, uint8_t scale);
 //                  (largely) the same.
 void fadeUsingColor( CRGB* leds, uint16_t numLeds, const CRGB& colormask);
 
+// The same, for 4-byte rgbw pixels, white included.  Each pixel is a
+// word, so these work on whole pixels at a time.
+void fadeLightBy(   CRGBW* leds, uint16_t num_leds, uint8_t fadeBy);
+void fade_video(    CRGBW* leds, uint16_t num_leds, uint8_t fadeBy);
+void nscale8_video( CRGBW* leds, uint16_t num_leds, uint8_t scale);
+void fadeToBlackBy( CRGBW* leds, uint16_t num_leds, uint8_t fadeBy);
+void fade_raw(      CRGBW* leds, uint16_t num_leds, uint8_t fadeBy);
+void nscale8(       CRGBW* leds, uint16_t num_leds, uint8_t scale);
+
 
 // Pixel blending
 //
@@ -302,6 +316,10 @@ void  nblend( CRGB* existing, CRGB* overlay, uint16_t count, fract8 amountOfOver
 void  nblend( CHSV* existing, CHSV* overlay, uint16_t count, fract8 amountOfOverlay,
              TGradientDirectionCode directionCode = SHORTEST_HUES);
 
+// nblend - the same, for 4-byte rgbw pixels, white included
+CRGBW& nblend( CRGBW& existing, const CRGBW& overlay, fract8 amountOfOverlay );
+void  nblend( CRGBW* existing, CRGBW* overlay, uint16_t count, fract8 amountOfOverlay);
+
 
 // blur1d: one-dimensional blur filter. Spreads light to 2 line neighbors.
 // blur2d: two-dimensional blur filter. Spreads light to 8 XY neighbors.
@@ -9,6 +9,7 @@
 #include "pixeltypes.h"
 #include "color.h"
 #include <stddef.h>
+#include <stdlib.h>
 
 FASTLED_NAMESPACE_BEGIN
 
@@ -25,6 +26,37 @@ FASTLED_NAMESPACE_BEGIN
 #define BINARY_DITHER 0x01
 typedef uint8_t EDitherMode;
 
+/// White extraction for RGBW leds.  Built from the color of the white led, in rgb terms (its
+/// white point): the white channel gets the most of that color that fits in the pixel, and
+/// that much is taken out of r, g and b.  With a pure white point this is min(r,g,b).
+struct CRGBWhite {
+    CRGB point;
+    uint16_t inv[3];    // 256 * 255 / point, or 0xFFFF for a channel the white led lacks
+
+    CRGBWhite() { set(CRGB(255,255,255)); }
+
+    void set(const CRGB & white) {
+        point = white;
+        for(int c = 0; c < 3; c++) {
+            inv[c] = point.raw[c] ? (255 * 256 + (point.raw[c] >> 1)) / point.raw[c] : 0xFFFF;
+        }
+    }
+
+    /// take the white out of three color bytes, given which of r, g, b (0-2) each one is
+    __attribute__((always_inline)) inline uint8_t extract(uint8_t & a, uint8_t & b, uint8_t & c, int ia, int ib, int ic) const {
+        uint32_t w = ((uint32_t)a * inv[ia]) >> 8;
+        uint32_t wb = ((uint32_t)b * inv[ib]) >> 8;
+        uint32_t wc = ((uint32_t)c * inv[ic]) >> 8;
+        if(wb < w) { w = wb; }
+        if(wc < w) { w = wc; }
+        if(w > 255) { w = 255; }
+        a = qsub8(a, scale8(w, point.raw[ia]));
+        b = qsub8(b, scale8(w, point.raw[ib]));
+        c = qsub8(c, scale8(w, point.raw[ic]));
+        return w;
+    }
+};
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // LED Controller interface definition
@@ -40,10 +72,14 @@ class CLEDController {
 protected:
     friend class CFastLED;
     CRGB *m_Data;
+    CRGB16 *m_Data16;
+    CRGBW *m_DataW;
     CLEDController *m_pNext;
     CRGB m_ColorCorrection;
     CRGB m_ColorTemperature;
     EDitherMode m_DitherMode;
+    bool m_Rgbw;
+    CRGBWhite m_White;
     int m_nLeds;
     static CLEDController *m_pHead;
     static CLEDController *m_pTail;
@@ -60,9 +96,24 @@ protected:
 	///@param scale the rgb scaling to apply to each led before writing it out
     virtual void show(const struct CRGB *data, int nLeds, CRGB scale) = 0;
 
+	/// write the passed in 16-bit rgb data out to the leds managed by this controller,
+	/// temporally dithered down to 8 bits.  Controllers that can't do this show nothing.
+	///@param data the rgb data to write out to the strip
+	///@param nLeds the number of leds being written out
+	///@param scale the rgb scaling to apply to each led before writing it out
+    virtual void show16(const struct CRGB16 * /*data*/, int /*nLeds*/, CRGB /*scale*/) { }
+
+	/// write the passed in 4-byte rgbw data out to the leds managed by this controller.
+	/// Controllers that can't do this show nothing.
+	///@param data the rgbw data to write out to the strip
+	///@param nLeds the number of leds being written out
+	///@param scale the rgb scaling to apply to each led before writing it out
+	///@param brightness the scaling to apply to the white channel
+    virtual void showW(const struct CRGBW * /*data*/, int /*nLeds*/, CRGB /*scale*/, uint8_t /*brightness*/) { }
+
 public:
 	/// create an led controller object, add it to the chain of controllers
-    CLEDController() : m_Data(NULL), m_ColorCorrection(UncorrectedColor), m_ColorTemperature(UncorrectedTemperature), m_DitherMode(BINARY_DITHER), m_nLeds(0) {
+    CLEDController() : m_Data(NULL), m_Data16(NULL), m_DataW(NULL), m_ColorCorrection(UncorrectedColor), m_ColorTemperature(UncorrectedTemperature), m_DitherMode(BINARY_DITHER), m_Rgbw(false), m_nLeds(0) {
         m_pNext = NULL;
         if(m_pHead==NULL) { m_pHead = this; }
         if(m_pTail != NULL) { m_pTail->m_pNext = this; }
@@ -87,7 +138,13 @@ public:
 
     /// show function using the "attached to this controller" led data
     void showLeds(uint8_t brightness=255) {
-        show(m_Data, m_nLeds, getAdjustment(brightness));
+        if(m_Data16) {
+            show16(m_Data16, m_nLeds, getAdjustment(brightness));
+        } else if(m_DataW) {
+            showW(m_DataW, m_nLeds, getAdjustment(brightness), brightness);
+        } else {
+            show(m_Data, m_nLeds, getAdjustment(brightness));
+        }
     }
 
 	/// show the given color on the led strip
@@ -103,6 +160,26 @@ public:
 	/// set the default array of leds to be used by this controller
     CLEDController & setLeds(CRGB *data, int nLeds) {
         m_Data = data;
+        m_Data16 = NULL;
+        m_DataW = NULL;
+        m_nLeds = nLeds;
+        return *this;
+    }
+
+	/// set a 16-bit array of leds to be used by this controller instead
+    CLEDController & setLeds(CRGB16 *data, int nLeds) {
+        m_Data = NULL;
+        m_Data16 = data;
+        m_DataW = NULL;
+        m_nLeds = nLeds;
+        return *this;
+    }
+
+	/// set a 4-byte rgbw array of leds to be used by this controller instead
+    CLEDController & setLeds(CRGBW *data, int nLeds) {
+        m_Data = NULL;
+        m_Data16 = NULL;
+        m_DataW = data;
         m_nLeds = nLeds;
         return *this;
     }
@@ -112,6 +189,12 @@ public:
         if(m_Data) {
             memset8((void*)m_Data, 0, sizeof(struct CRGB) * m_nLeds);
         }
+        if(m_Data16) {
+            memset8((void*)m_Data16, 0, sizeof(struct CRGB16) * m_nLeds);
+        }
+        if(m_DataW) {
+            memset8((void*)m_DataW, 0, sizeof(struct CRGBW) * m_nLeds);
+        }
     }
 
     /// How many leds does this controller manage?
@@ -120,6 +203,12 @@ public:
     /// Pointer to the CRGB array for this controller
     CRGB* leds() { return m_Data; }
 
+    /// Pointer to the CRGB16 array for this controller, if it was given one instead
+    CRGB16* leds16() { return m_Data16; }
+
+    /// Pointer to the CRGBW array for this controller, if it was given one instead
+    CRGBW* ledsW() { return m_DataW; }
+
     /// Reference to the n'th item in the controller
     CRGB &operator[](int x) { return m_Data[x]; }
 
@@ -128,6 +217,22 @@ public:
     /// get the dithering option currently set for this controller
     inline uint8_t getDither() { return m_DitherMode; }
 
+	/// drive RGBW leds: four bytes per led, the fourth being white taken out of the rgb color.
+	/// white is the color of the white led; the default, pure white, takes min(r,g,b).  Only
+	/// the ESP32 clockless controllers act on this.  Leds given as CRGBW bring their own white.
+    CLEDController & setRgbw(CRGB white = CRGB(255,255,255)) {
+        if(!white) { white = CRGB(255,255,255); }
+        m_White.set(white);
+        m_Rgbw = true;
+        return *this;
+    }
+    /// drive plain RGB leds again (the default)
+    CLEDController & setRgb() { m_Rgbw = false; return *this; }
+    /// is this controller driving RGBW leds?
+    bool isRgbw() const { return m_Rgbw; }
+    /// the white extraction used for RGBW leds
+    const CRGBWhite & getWhite() const { return m_White; }
+
 	/// the the color corrction to use for this controller, expressed as an rgb object
     CLEDController & setCorrection(CRGB correction) { m_ColorCorrection = correction; return *this; }
     /// set the color correction to use for this controller
@@ -171,6 +276,30 @@ public:
     virtual uint16_t getMaxRefreshRate() const { return 0; }
 };
 
+/// Scale tables for one controller: lut[channel][x] == scale8(x, scale.raw[channel]), for the
+/// scale the tables were last built for.  Lookups replace the scale8 multiply on every pixel
+/// byte; the tables are only rebuilt when the scale (brightness, correction or temperature)
+/// changes.  Channels are in CRGB (r,g,b) order, like CRGB::raw.
+struct CScaleLUT {
+    CRGB scale;
+    bool valid;
+    uint8_t lut[3][256];
+
+    CScaleLUT() : valid(false) {}
+
+    /// return the tables for the given scale, rebuilding them if it changed
+    const uint8_t (*get(const CRGB & s))[256] {
+        if(!valid || !(s == scale)) {
+            for(int c = 0; c < 3; c++) {
+                for(int x = 0; x < 256; x++) { lut[c][x] = scale8((uint8_t)x, s.raw[c]); }
+            }
+            scale = s;
+            valid = true;
+        }
+        return lut;
+    }
+};
+
 // Pixel controller class.  This is the class that we use to centralize pixel access in a block of data, including
 // support for things like RGB reordering, scaling, dithering, skipping (for ARGB data), and eventually, we will
 // centralize 8/12/16 conversions here as well.
@@ -183,6 +312,10 @@ struct PixelController {
         CRGB mScale;
         int8_t mAdvance;
         int mOffsets[LANES];
+        const uint8_t (*mLUT)[256];
+        uint8_t *mErr;
+        bool mHasWhite;
+        uint8_t mWhiteScale;
 
         PixelController(const PixelController & other) {
             d[0] = other.d[0];
@@ -193,6 +326,10 @@ struct PixelController {
             e[2] = other.e[2];
             mData = other.mData;
             mScale = other.mScale;
+            mLUT = other.mLUT;
+            mErr = other.mErr;
+            mHasWhite = other.mHasWhite;
+            mWhiteScale = other.mWhiteScale;
             mAdvance = other.mAdvance;
             mLenRemaining = mLen = other.mLen;
             for(int i = 0; i < LANES; i++) { mOffsets[i] = other.mOffsets[i]; }
@@ -207,25 +344,42 @@ struct PixelController {
           }
         }
 
-        PixelController(const uint8_t *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER, bool advance=true, uint8_t skip=0) : mData(d), mLen(len), mLenRemaining(len), mScale(s) {
+        PixelController(const uint8_t *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER, bool advance=true, uint8_t skip=0) : mData(d), mLen(len), mLenRemaining(len), mScale(s), mLUT(NULL), mErr(NULL), mHasWhite(false), mWhiteScale(0) {
             enable_dithering(dither);
             mData += skip;
             mAdvance = (advance) ? 3+skip : 0;
             initOffsets(len);
         }
 
-        PixelController(const CRGB *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)d), mLen(len), mLenRemaining(len), mScale(s) {
+        PixelController(const CRGB *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)d), mLen(len), mLenRemaining(len), mScale(s), mLUT(NULL), mErr(NULL), mHasWhite(false), mWhiteScale(0) {
             enable_dithering(dither);
             mAdvance = 3;
             initOffsets(len);
         }
 
-        PixelController(const CRGB &d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)&d), mLen(len), mLenRemaining(len), mScale(s) {
+        PixelController(const CRGB &d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)&d), mLen(len), mLenRemaining(len), mScale(s), mLUT(NULL), mErr(NULL), mHasWhite(false), mWhiteScale(0) {
             enable_dithering(dither);
             mAdvance = 0;
             initOffsets(len);
         }
 
+        // 16-bit data, temporally dithered: err holds the rounding error of each byte
+        // of the last frame (3 per led, starting at zero), which is carried into this one.
+        // Only the single lane loaders (loadAndScale0/1/2()) read 16-bit data.
+        PixelController(const CRGB16 *d, int len, CRGB & s, uint8_t *err) : mData((const uint8_t*)d), mLen(len), mLenRemaining(len), mScale(s), mLUT(NULL), mErr(err), mHasWhite(false), mWhiteScale(0) {
+            enable_dithering(DISABLE_DITHER);
+            mAdvance = 6;
+            initOffsets(len);
+        }
+
+        // 4-byte rgbw data: the color is read like CRGB data, a word apart, and the fourth
+        // byte is the white channel, scaled by whiteScale, for loadAndScaleRGBW()
+        PixelController(const CRGBW *d, int len, CRGB & s, EDitherMode dither, uint8_t whiteScale) : mData((const uint8_t*)d), mLen(len), mLenRemaining(len), mScale(s), mLUT(NULL), mErr(NULL), mHasWhite(true), mWhiteScale(whiteScale) {
+            enable_dithering(dither);
+            mAdvance = 4;
+            initOffsets(len);
+        }
+
         void init_binary_dithering() {
 #if !defined(NO_DITHERING) || (NO_DITHERING != 1)
 
@@ -324,7 +478,7 @@ struct PixelController {
         __attribute__((always_inline)) inline int advanceBy() { return mAdvance; }
 
         // advance the data pointer forward, adjust position counter
-         __attribute__((always_inline)) inline void advanceData() { mData += mAdvance; mLenRemaining--;}
+         __attribute__((always_inline)) inline void advanceData() { mData += mAdvance; mLenRemaining--; if(mErr) { mErr += 3; } }
 
         // step the dithering forward
          __attribute__((always_inline)) inline void stepDithering() {
@@ -346,11 +500,40 @@ struct PixelController {
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t dither(PixelController & pc, uint8_t b) { return b ? qadd8(b, pc.d[RO(SLOT)]) : 0; }
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t dither(PixelController & , uint8_t b, uint8_t d) { return b ? qadd8(b,d) : 0; }
 
+        // RGBW: load the three scaled color bytes, in output order, and take out the white
+        // the white led can supply, which is returned.  CRGBW data brings its own white.
+        __attribute__((always_inline)) inline uint8_t loadAndScaleRGBW(const CRGBWhite & white, uint8_t & b0, uint8_t & b1, uint8_t & b2) {
+            b0 = loadAndScale0();
+            b1 = loadAndScale1();
+            b2 = loadAndScale2();
+            if(mHasWhite) { return scale8(mData[3], mWhiteScale); }
+            return white.extract(b0, b1, b2, RO(0), RO(1), RO(2));
+        }
+
+        // set the scale tables to use instead of scale8; they must match mScale
+        void setScaleLUT(const uint8_t (*lut)[256]) { mLUT = lut; }
+
+#if (FASTLED_SCALE_LUT == 1)
+        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t scale(PixelController & pc, uint8_t b) { return pc.mLUT ? pc.mLUT[RO(SLOT)][b] : scale8(b, pc.mScale.raw[RO(SLOT)]); }
+#else
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t scale(PixelController & pc, uint8_t b) { return scale8(b, pc.mScale.raw[RO(SLOT)]); }
+#endif
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t scale(PixelController & , uint8_t b, uint8_t scale) { return scale8(b, scale); }
 
         // composite shortcut functions for loading, dithering, and scaling
-        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadAndScale(PixelController & pc) { return scale<SLOT>(pc, pc.dither<SLOT>(pc, pc.loadByte<SLOT>(pc))); }
+        // scale a 16-bit value, add the error carried over from the last frame, and send the
+        // top 8 bits; the bottom 8 carry over to the next frame.  Black stays black.
+        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadAndScale16(PixelController & pc) {
+            uint16_t v = ((const uint16_t*)pc.mData)[RO(SLOT)];
+            uint8_t & err = pc.mErr[RO(SLOT)];
+            if(!v) { err = 0; return 0; }
+            uint32_t t = (uint32_t)scale16by8(v, pc.mScale.raw[RO(SLOT)]) + err;
+            if(t > 0xFFFF) { err = 0; return 0xFF; }
+            err = t & 0xFF;
+            return t >> 8;
+        }
+
+        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadAndScale(PixelController & pc) { return pc.mErr ? loadAndScale16<SLOT>(pc) : scale<SLOT>(pc, pc.dither<SLOT>(pc, pc.loadByte<SLOT>(pc))); }
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadAndScale(PixelController & pc, int lane) { return scale<SLOT>(pc, pc.dither<SLOT>(pc, pc.loadByte<SLOT>(pc, lane))); }
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadAndScale(PixelController & pc, int lane, uint8_t d, uint8_t scale) { return scale8(pc.dither<SLOT>(pc, pc.loadByte<SLOT>(pc, lane), d), scale); }
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadAndScale(PixelController & pc, int lane, uint8_t scale) { return scale8(pc.loadByte<SLOT>(pc, lane), scale); }
@@ -388,6 +571,12 @@ struct PixelController {
 
 template<EOrder RGB_ORDER, int LANES=1, uint32_t MASK=0xFFFFFFFF> class CPixelLEDController : public CLEDController {
 protected:
+#if (FASTLED_SCALE_LUT == 1)
+  // scale tables for show(); showColor() doesn't use them, since clearing
+  // (with a black scale) would otherwise throw them away every time
+  CScaleLUT m_ScaleLUT;
+#endif
+
   virtual void showPixels(PixelController<RGB_ORDER,LANES,MASK> & pixels) = 0;
 
   /// set all the leds on the controller to a given color
@@ -405,11 +594,47 @@ protected:
 ///@param scale the rgb scaling to apply to each led before writing it out
   virtual void show(const struct CRGB *data, int nLeds, CRGB scale) {
     PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither());
+#if (FASTLED_SCALE_LUT == 1)
+    pixels.setScaleLUT(m_ScaleLUT.get(scale));
+#endif
+    showPixels(pixels);
+  }
+
+/// write the passed in 16-bit rgb data out to the leds managed by this controller,
+/// carrying each led's rounding error over to the next frame
+///@param data the rgb data to write out to the strip
+///@param nLeds the number of leds being written out
+///@param scale the rgb scaling to apply to each led before writing it out
+  virtual void show16(const struct CRGB16 *data, int nLeds, CRGB scale) {
+    if(m_nError < nLeds) {
+      free(m_Error);
+      m_Error = (uint8_t *) calloc(nLeds, 3);
+      m_nError = m_Error ? nLeds : 0;
+      if(!m_Error) { return; }
+    }
+    PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, m_Error);
+    showPixels(pixels);
+  }
+
+/// write the passed in 4-byte rgbw data out to the leds managed by this controller
+///@param data the rgbw data to write out to the strip
+///@param nLeds the number of leds being written out
+///@param scale the rgb scaling to apply to each led before writing it out
+///@param brightness the scaling to apply to the white channel
+  virtual void showW(const struct CRGBW *data, int nLeds, CRGB scale, uint8_t brightness) {
+    PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither(), brightness);
+#if (FASTLED_SCALE_LUT == 1)
+    pixels.setScaleLUT(m_ScaleLUT.get(scale));
+#endif
     showPixels(pixels);
   }
 
+  // rounding error of each led byte from the last 16-bit frame
+  uint8_t *m_Error;
+  int m_nError;
+
 public:
-  CPixelLEDController() : CLEDController() {}
+  CPixelLEDController() : CLEDController(), m_Error(NULL), m_nError(0) {}
 };
 
 
@@ -34,8 +34,10 @@
 // fix is enabled by default.  However, if for some reason you have code that is not
 // working right as a result of this (e.g. code that was expecting the old scale8 behavior)
 // you can disable it here.
+#ifndef FASTLED_SCALE8_FIXED
 #define FASTLED_SCALE8_FIXED 1
 // #define FASTLED_SCALE8_FIXED 0
+#endif
 
 // Use this toggle whether to use 'fixed' FastLED pixel blending, including ColorFromPalette.
 // The prior pixel blend functions had integer-rounding math errors that led to
@@ -61,6 +63,38 @@
 #define FASTLED_INTERRUPT_RETRY_COUNT 2
 #endif
 
+// Use this to have each controller keep a 256-entry table per color channel of its current
+// scale (color correction x temperature x brightness), rebuilt only when that scale changes, so
+// that loading a pixel byte is a table lookup instead of a scale8 multiply.  Costs 768 bytes of
+// RAM per controller, and 768 scale8 calls each time the scale changes, which is every frame
+// under power limiting or a brightness fade.  Only worth it for long strips with a steady
+// scale.  Set to 1 to turn it on.
+#ifndef FASTLED_SCALE_LUT
+#define FASTLED_SCALE_LUT 0
+#endif
+
+// When FastLED.show() is called before the refresh rate cap allows another frame, it sleeps the task
+// until shortly before the deadline and only spins for the last this many microseconds, which must
+// cover the time it takes the task to wake up again.
+#ifndef FASTLED_PACER_SPIN_US
+#define FASTLED_PACER_SPIN_US 200
+#endif
+
+// Use this to have FastLED.show() keep frame timing statistics (render interval, show time, per
+// controller times, RMT bailouts and retries), read with FastLED.getStats().  Costs a few calls
+// to micros() per frame.  Set to 1 to turn them on.
+#ifndef FASTLED_STATS
+#define FASTLED_STATS 0
+#endif
+
+// Use this to have the bulk CRGB array functions in colorutils (nscale8_video, fadeLightBy, nblend, ...)
+// work on four bytes per 32-bit multiply instead of one.  The results are the same either way.  nscale8
+// and fadeToBlackBy on CRGB arrays always go a led at a time, which is faster for them.  Only used where
+// scale8 is plain C (not on AVR).  Set to 0 to go a byte at a time.
+#ifndef FASTLED_COLORUTILS_SWAR
+#define FASTLED_COLORUTILS_SWAR 1
+#endif
+
 // Use this toggle to enable global brightness in contollers that support is (ADA102 and SK9822).
 // It changes how color scaling works and uses global brightness before scaling down color values.
 // This enable much more accurate color control on low brightness settings.
@@ -2,9 +2,11 @@
 #define __INC_FL_DELAY_H
 
 
+#ifndef FASTLED_HOST
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_timer.h"
+#endif
 
 #include "FastLED.h"
 
@@ -20,6 +22,12 @@ template<int WAIT> class CMinWait {
 public:
 	CMinWait() { mLastMicros = 0; }
 
+#ifdef FASTLED_HOST
+	// no scheduler to hand the time to, just watch the clock
+	void wait() { while ((micros() - mLastMicros) < WAIT); }
+
+	void mark() { mLastMicros = micros(); }
+#else
 	void wait() {
 		// how long I been waiting
 		uint64_t waited = esp_timer_get_time() - mLastMicros;
@@ -39,6 +47,7 @@ public:
 	}
 
 	void mark() { mLastMicros = esp_timer_get_time(); }
+#endif
 };
 
 
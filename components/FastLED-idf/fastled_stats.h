@@ -0,0 +1,87 @@
+#ifndef __INC_FASTLED_STATS_H
+#define __INC_FASTLED_STATS_H
+
+#include "FastLED.h"
+
+///@file fastled_stats.h
+/// frame timing statistics gathered by CFastLED::show(), see CFastLED::getStats()
+
+FASTLED_NAMESPACE_BEGIN
+
+/// Number of histogram buckets.  Bucket 0 counts times under 1ms, bucket i times
+/// under 2^i ms, and the last bucket everything longer.
+#ifndef FASTLED_STATS_BUCKETS
+#define FASTLED_STATS_BUCKETS 8
+#endif
+
+/// Number of controllers that get their own timing
+#ifndef FASTLED_STATS_MAX_CONTROLLERS
+#define FASTLED_STATS_MAX_CONTROLLERS 8
+#endif
+
+/// Running statistics for one kind of time, in microseconds
+struct CFastLEDTiming {
+	uint32_t last;				///< the most recent time
+	uint32_t min;				///< shortest time seen
+	uint32_t max;				///< longest time seen
+	uint64_t total;				///< sum of all the times, for the average
+	uint32_t count;				///< number of times added
+	uint32_t histogram[FASTLED_STATS_BUCKETS];
+
+	void reset() {
+		last = max = 0;
+		min = 0xFFFFFFFF;
+		total = 0;
+		count = 0;
+		for(int i = 0; i < FASTLED_STATS_BUCKETS; i++) { histogram[i] = 0; }
+	}
+
+	void add(uint32_t us) {
+		last = us;
+		if(us < min) { min = us; }
+		if(us > max) { max = us; }
+		total += us;
+		count++;
+		int bucket = 0;
+		uint32_t ms = us / 1000;
+		while(ms && bucket < FASTLED_STATS_BUCKETS - 1) { ms >>= 1; bucket++; }
+		histogram[bucket]++;
+	}
+
+	/// average time, or 0 if there are none yet
+	uint32_t avg() const { return count ? (uint32_t)(total / count) : 0; }
+};
+
+/// Everything CFastLED::show() keeps track of
+struct CFastLEDStats {
+	uint32_t frames;			///< frames shown since the last reset
+
+	CFastLEDTiming interval;	///< from the start of one show() to the start of the next
+	CFastLEDTiming show;		///< how long show() took, not counting the wait for the frame rate cap
+	CFastLEDTiming encode;		///< the part of show() not spent waiting on the wire (not kept with FASTLED_RMT_PIPELINE)
+	CFastLEDTiming wire;		///< how long the last finished frame took to send (RMT only, else 0)
+
+	/// how long each controller's part of show() took, in the order of FastLED[i]
+	uint32_t controllerShow[FASTLED_STATS_MAX_CONTROLLERS];
+	/// how long each RMT controller's last frame was on the wire, retries included
+	uint32_t controllerTransmit[FASTLED_STATS_MAX_CONTROLLERS];
+
+	uint32_t bailouts;			///< RMT frames cut short because an interrupt came too late
+	uint32_t retries;			///< RMT frames sent again after a bailout
+	uint32_t dropped;			///< RMT frames that stayed cut short (bailouts not retried)
+	uint32_t skipped;			///< RMT frames not sent because nothing changed
+
+	void reset() {
+		frames = 0;
+		interval.reset();
+		show.reset();
+		encode.reset();
+		wire.reset();
+		for(int i = 0; i < FASTLED_STATS_MAX_CONTROLLERS; i++) { controllerShow[i] = controllerTransmit[i] = 0; }
+		bailouts = retries = dropped = skipped = 0;
+	}
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -3,8 +3,10 @@
 
 /* defines get_millis() */
 
+#ifndef FASTLED_HOST
 #include "freertos/FreeRTOS.h"
 #include "esp_timer.h"
+#endif
 
 #include "FastLED.h"
 
@@ -926,7 +928,11 @@ typedef q<uint16_t, 12,4> q124;
 // fix that uses it
 
 #define GET_MILLIS() (get_millisecond_timer())
+#ifdef FASTLED_HOST
+static inline uint32_t get_millisecond_timer() { return millis(); }
+#else
 static inline uint32_t get_millisecond_timer() { return( esp_timer_get_time() / 1000);  }
+#endif
 
 // beat16 generates a 16-bit 'sawtooth' wave at a given BPM,
 ///        with BPM specified in Q8.8 fixed-point format; e.g.
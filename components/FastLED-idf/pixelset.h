@@ -124,15 +124,24 @@ public:
   /// Multiply every led in this set by the given value
   inline CPixelView & operator*=(uint8_t d) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel) *= d; } return *this; }
 
-  /// Scale every led by the given scale
-  inline CPixelView & nscale8_video(uint8_t scaledown) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel).nscale8_video(scaledown); } return *this;}
+  /// Scale every led by the given scale.  The leds are scaled in bulk (see ::nscale8_video),
+  /// whichever way the set runs, since each one is scaled on its own
+  inline CPixelView & nscale8_video(uint8_t scaledown) {
+    if(dir>0) { ::nscale8_video(leds, len, scaledown); }
+    else { ::nscale8_video(leds + len + 1, -len, scaledown); }
+    return *this;
+  }
   /// Scale down every led by the given scale
-  inline CPixelView & operator%=(uint8_t scaledown) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel).nscale8_video(scaledown); } return *this; }
+  inline CPixelView & operator%=(uint8_t scaledown) { return nscale8_video(scaledown); }
   /// Fade every led down by the given scale
   inline CPixelView & fadeLightBy(uint8_t fadefactor) { return nscale8_video(255 - fadefactor); }
 
-  /// Scale every led by the given scale
-  inline CPixelView & nscale8(uint8_t scaledown) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel).nscale8(scaledown); } return *this; }
+  /// Scale every led by the given scale, in bulk (see ::nscale8)
+  inline CPixelView & nscale8(uint8_t scaledown) {
+    if(dir>0) { ::nscale8(leds, len, scaledown); }
+    else { ::nscale8(leds + len + 1, -len, scaledown); }
+    return *this;
+  }
   /// Scale every led by the given scale
   inline CPixelView & nscale8(PIXEL_TYPE & scaledown) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel).nscale8(scaledown); } return *this; }
   /// Scale every led in this set by every led in the other set
@@ -227,7 +236,9 @@ public:
   }
 
   inline CPixelView & nblend(const PIXEL_TYPE & overlay, fract8 amountOfOverlay) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { ::nblend((*pixel), overlay, amountOfOverlay); } return *this; }
-  inline CPixelView & nblend(const CPixelView & rhs, fract8 amountOfOverlay) { for(iterator pixel = begin(), rhspixel = rhs.begin(), _end = end(), rhs_end = rhs.end(); (pixel != _end) && (rhspixel != rhs_end); ++pixel, ++rhspixel) { ::nblend((*pixel), (*rhspixel), amountOfOverlay); } return *this; }
+  inline CPixelView & nblend(const CPixelView & rhs, fract8 amountOfOverlay) {
+    if(dir>0 && rhs.dir>0) { ::nblend(leds, rhs.leds, (len < rhs.len) ? len : rhs.len, amountOfOverlay); return *this; }
+    for(iterator pixel = begin(), rhspixel = rhs.begin(), _end = end(), rhs_end = rhs.end(); (pixel != _end) && (rhspixel != rhs_end); ++pixel, ++rhspixel) { ::nblend((*pixel), (*rhspixel), amountOfOverlay); } return *this; }
 
   // Note: only bringing in a 1d blur, not sure 2d blur makes sense when looking at sub arrays
   inline CPixelView & blur1d(fract8 blur_amount) {
@@ -302,4 +313,19 @@ public:
   using CPixelView::operator=;
 };
 
+typedef CPixelView<CRGBW> CRGBWSet;
+
+__attribute__((always_inline))
+inline CRGBW *operator+(const CRGBWSet & pixels, int offset) { return (CRGBW*)pixels + offset; }
+
+/// An array of 4-byte rgbw leds (see CRGBW), word aligned, so its bulk
+/// operations work a pixel per word
+template<int SIZE>
+class CRGBWArray : public CPixelView<CRGBW> {
+  CRGBW rawleds[SIZE];
+public:
+  CRGBWArray() : CPixelView<CRGBW>(rawleds, SIZE) {}
+  using CPixelView::operator=;
+};
+
 #endif
@@ -864,6 +864,118 @@ inline CRGB operator%( const CRGB& p1, uint8_t d)
 }
 
 
+/// Representation of an RGB pixel with 16 bits per channel.  Controllers show it
+/// through temporal dithering: each pixel carries the rounding error of its last
+/// frame into the next, so over a few frames the LEDs average out to the full 16
+/// bit value even at low brightness, where 8 bit data visibly bands.  6 bytes per
+/// pixel, packed, read front to back once per frame, so the array can live in
+/// PSRAM (e.g. from heap_caps_malloc(..., MALLOC_CAP_SPIRAM)).
+struct CRGB16 {
+	union {
+		struct {
+			union { uint16_t r; uint16_t red; };
+			union { uint16_t g; uint16_t green; };
+			union { uint16_t b; uint16_t blue; };
+		};
+		uint16_t raw[3];
+	};
+
+	/// Array access operator to index into the crgb16 object
+	inline uint16_t& operator[] (uint8_t x) __attribute__((always_inline)) { return raw[x]; }
+
+	// default values are UNINITIALIZED
+	inline CRGB16() __attribute__((always_inline)) { }
+
+	/// allow construction from 16-bit R, G, B
+	inline CRGB16( uint16_t ir, uint16_t ig, uint16_t ib) __attribute__((always_inline))
+		: r(ir), g(ig), b(ib) { }
+
+	/// allow construction from an 8-bit CRGB, 0xFF becoming 0xFFFF
+	inline CRGB16( const CRGB& rhs) __attribute__((always_inline))
+		: r(rhs.r * 257), g(rhs.g * 257), b(rhs.b * 257) { }
+
+	/// the 8-bit color nearest to this one
+	inline operator CRGB() const __attribute__((always_inline)) {
+		return CRGB((r + 128 - (r >> 8)) >> 8, (g + 128 - (g >> 8)) >> 8, (b + 128 - (b >> 8)) >> 8);
+	}
+};
+
+/// Representation of an RGB pixel padded to four bytes, the fourth being white.
+/// Every pixel sits on a 32-bit word, so the bulk functions in colorutils can
+/// load, scale and store a whole pixel with word operations, at the cost of a
+/// third more memory than CRGB.  Controllers set to RGBW (setRgbw()) send w as
+/// the white channel, scaled by the brightness only, instead of taking white out
+/// of the color; plain RGB controllers ignore it.
+struct CRGBW {
+	union {
+		struct {
+			union { uint8_t r; uint8_t red; };
+			union { uint8_t g; uint8_t green; };
+			union { uint8_t b; uint8_t blue; };
+			union { uint8_t w; uint8_t white; };
+		};
+		uint8_t raw[4];
+		uint32_t raw32;
+	};
+
+	/// Array access operator to index into the crgbw object
+	inline uint8_t& operator[] (uint8_t x) __attribute__((always_inline)) { return raw[x]; }
+
+	/// Array access operator to index into the crgbw object
+	inline const uint8_t& operator[] (uint8_t x) const __attribute__((always_inline)) { return raw[x]; }
+
+	// default values are UNINITIALIZED
+	inline CRGBW() __attribute__((always_inline)) { }
+
+	/// allow construction from R, G, B and W
+	inline CRGBW( uint8_t ir, uint8_t ig, uint8_t ib, uint8_t iw = 0) __attribute__((always_inline))
+		: r(ir), g(ig), b(ib), w(iw) { }
+
+	/// allow construction from a CRGB, with no white
+	inline CRGBW( const CRGB& rhs) __attribute__((always_inline))
+		: r(rhs.r), g(rhs.g), b(rhs.b), w(0) { }
+
+	/// allow construction from a named color, with no white
+	inline CRGBW( CRGB::HTMLColorCode colorcode) __attribute__((always_inline))
+		: r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b((colorcode >> 0) & 0xFF), w(0) { }
+
+	/// the color, without the white
+	inline operator CRGB() const __attribute__((always_inline)) { return CRGB(r, g, b); }
+
+	/// true if any channel is lit
+	inline operator bool() const __attribute__((always_inline)) { return raw32 != 0; }
+
+	/// scale all four channels down to N 256ths, see CRGB::nscale8_video
+	inline CRGBW& nscale8_video( uint8_t scaledown) {
+		nscale8x3_video( r, g, b, scaledown);
+		w = scale8_video( w, scaledown);
+		return *this;
+	}
+
+	/// scale all four channels down to N 256ths, see CRGB::nscale8
+	inline CRGBW& nscale8( uint8_t scaledown) {
+		nscale8x3( r, g, b, scaledown);
+		w = scale8( w, scaledown);
+		return *this;
+	}
+
+	/// fadeLightBy is a synonym for nscale8_video( ..., 255-fadefactor)
+	inline CRGBW& fadeLightBy( uint8_t fadefactor) { return nscale8_video( 255 - fadefactor); }
+
+	/// fadeToBlackBy is a synonym for nscale8( ..., 255-fadefactor)
+	inline CRGBW& fadeToBlackBy( uint8_t fadefactor) { return nscale8( 255 - fadefactor); }
+};
+
+inline __attribute__((always_inline)) bool operator== (const CRGBW& lhs, const CRGBW& rhs)
+{
+	return lhs.raw32 == rhs.raw32;
+}
+
+inline __attribute__((always_inline)) bool operator!= (const CRGBW& lhs, const CRGBW& rhs)
+{
+	return lhs.raw32 != rhs.raw32;
+}
+
 
 /// RGB orderings, used when instantiating controllers to determine what
 /// order the controller should send RGB data out in, RGB being the default
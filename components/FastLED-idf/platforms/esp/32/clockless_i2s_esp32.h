@@ -5,9 +5,11 @@
  * Copyright (c) 2019 Samuel Z. Guyer
  * Derived from lots of code examples from other people.
  *
- * The I2S implementation can drive up to 24 strips in parallel, but
- * with the following limitation: all the strips must have the same
- * timing (i.e., they must all use the same chip).
+ * The I2S implementation can drive up to 24 strips in parallel. The
+ * strips can use different chips: they share one data clock, picked
+ * to fit the timings of all of them as well as it can, and one bit
+ * time, that of the slowest chip (faster chips just stay low a little
+ * longer at the end of each bit).
  *
  * To enable the I2S driver, add the following line *before* including
  * FastLED.h (no other changes are necessary):
@@ -53,16 +55,37 @@
  *      parallel data bits turn into 10 X 24 pulses.
  *
  * We send data to the I2S peripheral using the DMA interface. We use
- * two DMA buffers, so that we can fill one buffer while the other
- * buffer is being sent. Each DMA buffer holds the fully-expanded
- * pulse pattern for one pixel on up to 24 strips. The exact amount of
- * memory required depends on the number of color channels and the
- * number of pulses used to encode each bit.
+ * a ring of FASTLED_ESP32_I2S_NUM_DMA_BUFFERS DMA buffers, so that we
+ * can fill some buffers while the others are being sent. Each DMA
+ * buffer holds the fully-expanded pulse pattern for
+ * FASTLED_ESP32_I2S_ROWS_PER_DMA_BUFFER pixels on up to 24 strips.
+ * The exact amount of memory required depends on the number of color
+ * channels and the number of pulses used to encode each bit: a row is
+ * 8 bits x channels x pulses per bit, of 4 bytes each. For WS2812 (10
+ * pulses per bit) that is 960 bytes for RGB and 1280 for RGBW.
  *
  * We get an interrupt each time a buffer is sent; we then fill that
- * buffer while the next one is being sent. The DMA interface allows
+ * buffer while the next ones are being sent. The DMA interface allows
  * us to configure the buffers as a circularly linked list, so that it
- * can automatically start on the next buffer.
+ * can automatically start on the next buffer. If an interrupt comes
+ * late and the DMA has finished more than one buffer by then, we
+ * refill all of them. So the interrupt handler has the time it takes
+ * to send all but one of the buffers to respond, rather than the
+ * ~30us of a single pixel row with two one-row buffers.
+ *
+ * Normally steps 1 and 2 run in the interrupt handler, a pixel row at
+ * a time. With FASTLED_ESP32_I2S_PRETRANSPOSE set to 1, show() does
+ * them for the whole frame before it starts the I2S, into a buffer
+ * of bit planes (for each row, the 24 parallel bits of each bit of
+ * each color channel), and the interrupt handler only does step 3,
+ * copying a row of it out into the DMA buffer. That keeps scaling,
+ * dithering and transposing out of interrupt context, so a late
+ * interrupt (e.g., from WiFi) has much less work to catch up on. The
+ * buffer takes 4 + 32 bytes per color channel for each led on the
+ * longest strip (100 bytes for RGB); set
+ * FASTLED_ESP32_I2S_PRETRANSPOSE_PSRAM to 1 to put it in PSRAM when
+ * there is some. If it can't be allocated, show() falls back to the
+ * normal way.
  */
 /*
  * Permission is hereby granted, free of charge, to any person obtaining a copy
@@ -89,8 +112,13 @@
 // This is way too noisy. Is output a LARGE NUMBER of times.
 // #pragma message "NOTE: ESP32 support using I2S parallel driver. All strips must use the same chipset"
 
+#ifdef FASTLED_I2S_EMULATOR
+#include "platforms/host/i2s_emulator.h"
+#endif
+
 FASTLED_NAMESPACE_BEGIN
 
+#ifndef FASTLED_I2S_EMULATOR
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -114,15 +142,22 @@ extern "C" {
 #ifdef __cplusplus
 }
 #endif
+#endif
 
 __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
+#ifdef FASTLED_I2S_EMULATOR
+    return i2s_emulator_cycles();
+#else
     uint32_t cyc;
     __asm__ __volatile__ ("rsr %0,ccount":"=a" (cyc));
     return cyc;
+#endif
 }
 
 #define FASTLED_HAS_CLOCKLESS 1
-#define NUM_COLOR_CHANNELS 3
+// -- Most color channels per led (RGBW); the scratch rows are sized for
+//    it, the DMA buffers only for the channels in use (gNumColorChannels)
+#define NUM_COLOR_CHANNELS 4
 
 // -- Choose which I2S device to use
 #ifndef I2S_DEVICE
@@ -134,6 +169,15 @@ __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
 #define FASTLED_I2S_MAX_CONTROLLERS 24
 #endif
 
+// -- Scale and transpose the whole frame before sending it (see above)
+#ifndef FASTLED_ESP32_I2S_PRETRANSPOSE
+#define FASTLED_ESP32_I2S_PRETRANSPOSE 0
+#endif
+
+#ifndef FASTLED_ESP32_I2S_PRETRANSPOSE_PSRAM
+#define FASTLED_ESP32_I2S_PRETRANSPOSE_PSRAM 0
+#endif
+
 // -- I2S clock
 #define I2S_BASE_CLK (80000000L)
 #define I2S_MAX_CLK (20000000L) //more tha a certain speed and the I2s loses some bits
@@ -141,6 +185,29 @@ __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
 // -- Convert ESP32 cycles back into nanoseconds
 #define ESPCLKS_TO_NS(_CLKS) (((long)(_CLKS) * 1000L) / F_CPU_MHZ)
 
+// -- Pulse length in CPU clocks for timings a, b and c (see
+//    initBitPatterns): the largest length they are all a multiple of,
+//    give or take precision clocks, that is more than 1 clock and
+//    gives at most I2S_MAX_PULSE_PER_BIT pulses per bit. These are
+//    constexpr so that the encoder can be unrolled for each chipset.
+static constexpr int i2sPulseClocks(int i, int precision, int a, int b, int c)
+{
+    return (i <= 0) ? 1
+        : (a % i <= precision && b % i <= precision && c % i <= precision) ? i
+        : i2sPulseClocks(i - 1, precision, a, b, c);
+}
+
+static constexpr int i2sPulseClocksFor(int smallest, int precision, int a, int b, int c)
+{
+    return (precision < smallest
+            && (i2sPulseClocks(smallest, precision, a, b, c) == 1
+                || a / i2sPulseClocks(smallest, precision, a, b, c)
+                 + b / i2sPulseClocks(smallest, precision, a, b, c)
+                 + c / i2sPulseClocks(smallest, precision, a, b, c) > I2S_MAX_PULSE_PER_BIT))
+        ? i2sPulseClocksFor(smallest, precision + 1, a, b, c)
+        : i2sPulseClocks(smallest, precision, a, b, c);
+}
+
 // -- Array of all controllers
 static CLEDController * gControllers[FASTLED_I2S_MAX_CONTROLLERS];
 static int gNumControllers = 0;
@@ -168,26 +235,96 @@ struct DMABuffer {
     uint8_t * buffer;
 };
 
-#define NUM_DMA_BUFFERS 2
+// -- Number of DMA buffers in the ring (2 to 16), and the number of
+//    pixel rows in each one. A buffer can't be bigger than 4092 bytes,
+//    so the rows per buffer are cut down to fit if needed.
+#ifndef FASTLED_ESP32_I2S_NUM_DMA_BUFFERS
+#define FASTLED_ESP32_I2S_NUM_DMA_BUFFERS 4
+#endif
+
+#ifndef FASTLED_ESP32_I2S_ROWS_PER_DMA_BUFFER
+#define FASTLED_ESP32_I2S_ROWS_PER_DMA_BUFFER 2
+#endif
+
+#if FASTLED_ESP32_I2S_NUM_DMA_BUFFERS < 2 || FASTLED_ESP32_I2S_NUM_DMA_BUFFERS > 16
+#error "FASTLED_ESP32_I2S_NUM_DMA_BUFFERS must be between 2 and 16"
+#endif
+
+#define NUM_DMA_BUFFERS FASTLED_ESP32_I2S_NUM_DMA_BUFFERS
+#define MAX_DMA_BUFFER_BYTES 4092
 static DMABuffer * dmaBuffers[NUM_DMA_BUFFERS];
+static int gRowsPerBuffer = 1;
+static int gDMABufferBytes = 0;
 
 // -- Bit patterns
-//    For now, we require all strips to be the same chipset, so these
-//    are global variables.
-
+//    Every strip sends gPulsesPerBit pulses per bit, but each one is
+//    high for as many of them as its own chip wants. For pulse k of a
+//    bit, gLeadMask[k] has the strips that are high whatever the bit
+//    is, and gDataMask[k] the strips that send the bit itself. Only
+//    pulses gDataStart up to gDataEnd have any data in them.
 static int      gPulsesPerBit = 0;
-static uint32_t gOneBit[40] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-static uint32_t gZeroBit[40]  = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+static uint32_t gLeadMask[I2S_MAX_PULSE_PER_BIT];
+static uint32_t gDataMask[I2S_MAX_PULSE_PER_BIT];
+static int      gDataStart = 0;
+static int      gDataEnd = 0;
+
+// -- True when all the strips have the same bit patterns (the usual
+//    case), so expandRow can use its unrolled version
+static bool gSameTiming = true;
+
+// -- T1, T2 and T3 of each controller, in CPU clocks. When a
+//    controller is added, the next show() works out the bit patterns,
+//    the clock and the DMA buffers again.
+static int gTimings[FASTLED_I2S_MAX_CONTROLLERS][3];
+static bool gTimingsChanged = false;
+
+// -- Each controller's loadPixel, which knows its color order
+typedef void (*LoadPixelFn)(CLEDController * controller, int bit_index);
+static LoadPixelFn gLoadPixel[FASTLED_I2S_MAX_CONTROLLERS];
+
+// -- The schedule for the frame: the controllers, longest strip first,
+//    and the length of each. Only the first gActiveLanes of them still
+//    have pixels to send after gRowsLoaded rows, and gActiveMask has
+//    their bits (same bits as the data mask in fillBuffer). So each
+//    row only touches the strips that are still going.
+static int gLaneOrder[FASTLED_I2S_MAX_CONTROLLERS];
+static int gLaneLength[FASTLED_I2S_MAX_CONTROLLERS];
+static int gActiveLanes = 0;
+static uint32_t gActiveMask = 0;
+static int gRowsLoaded = 0;
 
 // -- Counters to track progress
 static int gCurBuffer = 0;
 static bool gDoneFilling = false;
-static int ones_for_one;
-static int ones_for_zero;
+static int gLastBuffer = 0;
+
+// -- Color channels sent per led this frame: 4 if any strip is RGBW.
+//    The strips that are RGBW are in gRgbwMask (same bits as the data
+//    mask in fillBuffer); the others stay low while the white goes out.
+static int gNumColorChannels = 3;
+static uint32_t gRgbwMask = 0;
+
+#if FASTLED_ESP32_TRACE == 1
+// -- Cycle count at the last buffer fill, for the event trace
+static uint32_t gLastFill = 0;
+#endif
 
 // -- Temp buffers for pixels and bits being formatted for DMA
 static uint8_t gPixelRow[NUM_COLOR_CHANNELS][32];
 static uint8_t gPixelBits[NUM_COLOR_CHANNELS][8][4];
+
+// -- One transposed row: the mask of the strips that have data in it,
+//    then the parallel bits of each channel, bit 7 first, already masked
+#define ROW_WORDS(_CHANNELS) (1 + 8 * (_CHANNELS))
+
+#if FASTLED_ESP32_I2S_PRETRANSPOSE == 1
+// -- The pre-transposed frame: gFrameRows rows of ROW_WORDS(gNumColorChannels)
+//    words; gFrameRow is the next one to send. Grows as needed, never shrinks.
+static uint32_t * gFrameBits = NULL;
+static int gFrameBitsSize = 0;
+static int gFrameRows = 0;
+static int gFrameRow = 0;
+#endif
 static int CLOCK_DIVIDER_N;
 static int CLOCK_DIVIDER_A;
 static int CLOCK_DIVIDER_B;
@@ -207,6 +344,15 @@ class ClocklessController : public CPixelLEDController<RGB_ORDER>
     // -- Make sure we can't call show() too quickly
     CMinWait<55>   mWait;
 
+    // -- The encoding of a bit, in pulses, when all the strips are this
+    //    chip: all high for ONES_FOR_ZERO, then the data bit up to
+    //    ONES_FOR_ONE, then low up to PULSES_PER_BIT. Known at compile
+    //    time, so expandBit unrolls.
+    static constexpr int PULSE_CLOCKS = i2sPulseClocksFor((T1 < T2 ? (T1 < T3 ? T1 : T3) : (T2 < T3 ? T2 : T3)), 0, T1, T2, T3);
+    static constexpr int ONES_FOR_ZERO = T1 / PULSE_CLOCKS;
+    static constexpr int ONES_FOR_ONE = T1 / PULSE_CLOCKS + T2 / PULSE_CLOCKS;
+    static constexpr int PULSES_PER_BIT = T1 / PULSE_CLOCKS + T2 / PULSE_CLOCKS + T3 / PULSE_CLOCKS;
+
  public:
 
     void init()
@@ -220,6 +366,13 @@ class ClocklessController : public CPixelLEDController<RGB_ORDER>
         gControllers[gNumControllers] = this;
         int my_index = gNumControllers;
         gNumControllers++;
+
+        // -- Remember how to encode and load this strip
+        gTimings[my_index][0] = T1;
+        gTimings[my_index][1] = T2;
+        gTimings[my_index][2] = T3;
+        gLoadPixel[my_index] = &loadPixel;
+        gTimingsChanged = true;
         
         // -- Set up the pin We have to do two things: configure the
         //    actual GPIO pin, and route the output from the default
@@ -239,21 +392,6 @@ class ClocklessController : public CPixelLEDController<RGB_ORDER>
     
 protected:
    
-   static int pgcd(int smallest,int precision,int a,int b,int c)
-    {
-        int pgc_=1;
-        for( int i=smallest;i>0;i--)
-        {
-            
-            if( a%i<=precision && b%i<=precision && c%i<=precision)
-            {
-                pgc_=i;
-                break;
-            }
-        }
-        return pgc_;
-    }
-    
     /** Compute pules/bit patterns
      *
      *  This is Yves Bazin's mad code for computing the pulse pattern
@@ -269,54 +407,62 @@ protected:
         // Precompute the bit patterns based on the I2S sample rate
         // println("Setting up fastled using I2S");
 
-        // -- First, convert back to ns from CPU clocks
-        uint32_t T1ns = ESPCLKS_TO_NS(T1);
-        uint32_t T2ns = ESPCLKS_TO_NS(T2);
-        uint32_t T3ns = ESPCLKS_TO_NS(T3);
-        
-        // print("T1 = "); print(T1); print(" ns "); println(T1ns);
-        // print("T2 = "); print(T2); print(" ns "); println(T2ns);
-        // print("T3 = "); print(T3); print(" ns "); println(T3ns);
-        
         /*
          We calculate the best pcgd to the timing
          ie
          WS2811 77 77 154 => 1  1 2 => nb pulses= 4
          WS2812 60 150 90 => 2 5 3 => nb pulses=10
+         With more than one chip, the pulse has to fit all their
+         timings (see i2sPulseClocksFor, which does it for one).
          */
-        int smallest=0;
-        if (T1>T2)
-            smallest=T2;
-        else
-            smallest=T1;
-        if(smallest>T3)
-            smallest=T3;
-        double freq=(double)1/(double)(T1ns + T2ns + T3ns);
-        // printf("chipset frequency:%f Khz\n", 1000000L*freq);
-       // printf("smallest %d\n",smallest);
-        int pgc_=1;
+        int smallest=gTimings[0][0];
+        for (int i = 0; i < gNumControllers; i++) {
+            for (int t = 0; t < 3; t++) {
+                if (gTimings[i][t] < smallest) smallest = gTimings[i][t];
+            }
+        }
         int precision=0;
-        pgc_=pgcd(smallest,precision,T1,T2,T3);
-        //printf("%f\n",I2S_MAX_CLK/(1000000000L*freq));
-        while(pgc_==1 ||  (T1/pgc_ +T2/pgc_ +T3/pgc_)>I2S_MAX_PULSE_PER_BIT) //while(pgc_==1 ||  (T1/pgc_ +T2/pgc_ +T3/pgc_)>I2S_MAX_CLK/(1000000000L*freq))
+        int pgc_=pgcd(smallest,precision);
+        while(precision < smallest && (pgc_==1 || maxPulses(pgc_)>I2S_MAX_PULSE_PER_BIT))
         {
             precision++;
-            pgc_=pgcd(smallest,precision,T1,T2,T3);
-            //printf("%d %d\n",pgc_,(a+b+c)/pgc_);
+            pgc_=pgcd(smallest,precision);
         }
-        pgc_=pgcd(smallest,precision,T1,T2,T3);
         // printf("pgcd %d precision:%d\n",pgc_,precision);
-        // printf("nb pulse per bit:%d\n",T1/pgc_ +T2/pgc_ +T3/pgc_);
-        gPulsesPerBit=(int)T1/pgc_ +(int)T2/pgc_ +(int)T3/pgc_;
+
         /*
-         we calculate the duration of one pulse nd htre base frequency of the led
+         Every strip gets the same number of pulses per bit, that of the
+         slowest chip. With one chip, the pulse is the bit time over the
+         number of pulses:
          ie WS2812B F=1/(250+625+375)=800kHz or 1250ns
          as we need 10 pulses each pulse is 125ns => frequency 800Khz*10=8MHz
          WS2811 T=320+320+641=1281ns qnd we need 4 pulses => pulse duration 320.25ns =>frequency 3.1225605Mhz
-         
+         With more than one, it is the length that gets the high times (T1 for a
+         zero, T1+T2 for a one) of all of them closest, in the least
+         squares sense; the low times can be longer than asked for.
          */
-
-        freq=1000000000L*freq*gPulsesPerBit;
+        gPulsesPerBit = maxPulses(pgc_);
+        bool one_chip = true;
+        for (int i = 1; i < gNumControllers; i++) {
+            for (int t = 0; t < 3; t++) {
+                if (gTimings[i][t] != gTimings[0][t]) one_chip = false;
+            }
+        }
+        double freq;
+        if (one_chip) {
+            freq=(double)1/(double)(ESPCLKS_TO_NS(gTimings[0][0]) + ESPCLKS_TO_NS(gTimings[0][1]) + ESPCLKS_TO_NS(gTimings[0][2]));
+            freq=1000000000L*freq*gPulsesPerBit;
+        } else {
+            double sum_nt = 0;
+            double sum_nn = 0;
+            for (int i = 0; i < gNumControllers; i++) {
+                int ones_for_zero = gTimings[i][0]/pgc_;
+                int ones_for_one = gTimings[i][0]/pgc_ + gTimings[i][1]/pgc_;
+                sum_nt += ones_for_zero * (double)ESPCLKS_TO_NS(gTimings[i][0]) + ones_for_one * (double)ESPCLKS_TO_NS(gTimings[i][0] + gTimings[i][1]);
+                sum_nn += ones_for_zero * ones_for_zero + ones_for_one * ones_for_one;
+            }
+            freq=1000000000L*sum_nn/sum_nt;
+        }
         // printf("needed frequency (nbpiulse per bit)*(chispset frequency):%f Mhz\n",freq/1000000);
         
         /*
@@ -366,56 +512,57 @@ protected:
             CLOCK_DIVIDER_N++;
         }
         
-        //printf("%d %d %f %f %d\n",CLOCK_DIVIDER_B,CLOCK_DIVIDER_A,(double)CLOCK_DIVIDER_B/CLOCK_DIVIDER_A,v,CLOCK_DIVIDER_N);
-        //printf("freq %f %f\n",freq,I2S_BASE_CLK/(CLOCK_DIVIDER_N+(double)CLOCK_DIVIDER_B/CLOCK_DIVIDER_A));
-        freq=1/(CLOCK_DIVIDER_N+(double)CLOCK_DIVIDER_B/CLOCK_DIVIDER_A);
-        freq=freq*I2S_BASE_CLK;
-        // printf("calculted for i2s frequency:%f Mhz N:%d B:%d A:%d\n",freq/1000000,CLOCK_DIVIDER_N,CLOCK_DIVIDER_B,CLOCK_DIVIDER_A);
-        // double pulseduration=1000000000/freq;
-        // printf("Pulse duration: %f ns\n",pulseduration);
-        // gPulsesPerBit = (T1ns + T2ns + T3ns)/FASTLED_I2S_NS_PER_PULSE;
-        
-        //print("Pulses per bit: "); println(gPulsesPerBit);
-        
-        //int ones_for_one  = ((T1ns + T2ns - 1)/FASTLED_I2S_NS_PER_PULSE) + 1;
-        ones_for_one  = T1/pgc_ +T2/pgc_;
-        //print("One bit:  target ");
-        //print(T1ns+T2ns); print("ns --- ");
-        //print(ones_for_one); print(" 1 bits");
-        //print(" = "); print(ones_for_one * FASTLED_I2S_NS_PER_PULSE); println("ns");
-        // printf("one bit : target %d  ns --- %d  pulses 1 bit = %f ns\n",T1ns+T2ns,ones_for_one ,ones_for_one*pulseduration);
-        
-        
-        int i = 0;
-        while ( i < ones_for_one ) {
-            gOneBit[i] = 0xFFFFFF00;
-            i++;
-        }
-        while ( i < gPulsesPerBit ) {
-            gOneBit[i] = 0x00000000;
-            i++;
-        }
-        
-        //int ones_for_zero = ((T1ns - 1)/FASTLED_I2S_NS_PER_PULSE) + 1;
-        ones_for_zero =T1/pgc_  ;
-       // print("Zero bit:  target ");
-       // print(T1ns); print("ns --- ");
-        //print(ones_for_zero); print(" 1 bits");
-        //print(" = "); print(ones_for_zero * FASTLED_I2S_NS_PER_PULSE); println("ns");
-        // printf("Zero bit : target %d ns --- %d pulses  1 bit =   %f ns\n",T1ns,ones_for_zero ,ones_for_zero*pulseduration);
-        i = 0;
-        while ( i < ones_for_zero ) {
-            gZeroBit[i] = 0xFFFFFF00;
-            i++;
+        // -- Each strip is high for the first T1 (zero) or T1+T2 (one) of its pulses
+        for (int k = 0; k < gPulsesPerBit; k++) {
+            gLeadMask[k] = 0;
+            gDataMask[k] = 0;
         }
-        while ( i < gPulsesPerBit ) {
-            gZeroBit[i] = 0x00000000;
-            i++;
+        gDataStart = gPulsesPerBit;
+        gDataEnd = 0;
+        gSameTiming = true;
+        for (int i = 0; i < gNumControllers; i++) {
+            int ones_for_zero = gTimings[i][0]/pgc_;
+            int ones_for_one = gTimings[i][0]/pgc_ + gTimings[i][1]/pgc_;
+            uint32_t lane = 1 << (i+8);
+            for (int k = 0; k < ones_for_zero; k++) gLeadMask[k] |= lane;
+            for (int k = ones_for_zero; k < ones_for_one; k++) gDataMask[k] |= lane;
+            if (i > 0 && (ones_for_zero != gDataStart || ones_for_one != gDataEnd)) gSameTiming = false;
+            if (ones_for_zero < gDataStart) gDataStart = ones_for_zero;
+            if (ones_for_one > gDataEnd) gDataEnd = ones_for_one;
         }
         
         memset(gPixelRow, 0, NUM_COLOR_CHANNELS * 32);
         memset(gPixelBits, 0, NUM_COLOR_CHANNELS * 32);
     }
+
+    /** Largest pulse length that all the timings are a multiple of,
+     *  give or take precision CPU clocks
+     */
+    static int pgcd(int smallest,int precision)
+    {
+        for (int i=smallest;i>0;i--) {
+            bool fits = true;
+            for (int c = 0; c < gNumControllers; c++) {
+                for (int t = 0; t < 3; t++) {
+                    if (gTimings[c][t] % i > precision) fits = false;
+                }
+            }
+            if (fits) return i;
+        }
+        return 1;
+    }
+
+    /** Pulses per bit of the slowest chip, for the given pulse length
+     */
+    static int maxPulses(int pgc_)
+    {
+        int most = 0;
+        for (int i = 0; i < gNumControllers; i++) {
+            int pulses = gTimings[i][0]/pgc_ + gTimings[i][1]/pgc_ + gTimings[i][2]/pgc_;
+            if (pulses > most) most = pulses;
+        }
+        return most;
+    }
     
     static DMABuffer * allocateDMABuffer(int bytes)
     {
@@ -442,9 +589,6 @@ protected:
         // -- Only need to do this once
         if (gInitialized) return;
         
-        // -- Construct the bit patterns for ones and zeros
-        initBitPatterns();
-        
         // -- Choose whether to use I2S device 0 or device 1
         //    Set up the various device-specific parameters
         int interruptSource;
@@ -486,13 +630,6 @@ protected:
         i2s->clkm_conf.val = 0;
         i2s->clkm_conf.clka_en = 0;
         
-        // -- Data clock is computed as Base/(div_num + (div_b/div_a))
-        //    Base is 80Mhz, so 80/(10 + 0/1) = 8Mhz
-        //    One cycle is 125ns
-        i2s->clkm_conf.clkm_div_a = CLOCK_DIVIDER_A;
-        i2s->clkm_conf.clkm_div_b = CLOCK_DIVIDER_B;
-        i2s->clkm_conf.clkm_div_num = CLOCK_DIVIDER_N;
-        
         i2s->fifo_conf.val = 0;
         i2s->fifo_conf.tx_fifo_mod_force_en = 1;
         i2s->fifo_conf.tx_fifo_mod = 3;  // 32-bit single channel data
@@ -508,14 +645,6 @@ protected:
         
         i2s->timing.val = 0;
         
-        // -- Allocate two DMA buffers
-        dmaBuffers[0] = allocateDMABuffer(32 * NUM_COLOR_CHANNELS * gPulsesPerBit);
-        dmaBuffers[1] = allocateDMABuffer(32 * NUM_COLOR_CHANNELS * gPulsesPerBit);
-        
-        // -- Arrange them as a circularly linked list
-        dmaBuffers[0]->descriptor.qe.stqe_next = &(dmaBuffers[1]->descriptor);
-        dmaBuffers[1]->descriptor.qe.stqe_next = &(dmaBuffers[0]->descriptor);
-       
         // -- Allocate i2s interrupt
         SET_PERI_REG_BITS(I2S_INT_ENA_REG(I2S_DEVICE), I2S_OUT_EOF_INT_ENA_V, 1, I2S_OUT_EOF_INT_ENA_S);
         ESP_ERROR_CHECK(
@@ -535,20 +664,66 @@ protected:
         gInitialized = true;
     }
     
+    /** Set up the timing
+     *
+     *  Work out the bit patterns and the data clock for all the
+     *  controllers, and make the DMA buffers big enough for them.
+     *  Called by show() when controllers have been added.
+     */
+    static void i2sSetTiming()
+    {
+        // -- Construct the bit patterns for ones and zeros
+        initBitPatterns();
+        
+        // -- Data clock is computed as Base/(div_num + (div_b/div_a))
+        //    Base is 80Mhz, so 80/(10 + 0/1) = 8Mhz
+        //    One cycle is 125ns
+        i2s->clkm_conf.clkm_div_a = CLOCK_DIVIDER_A;
+        i2s->clkm_conf.clkm_div_b = CLOCK_DIVIDER_B;
+        i2s->clkm_conf.clkm_div_num = CLOCK_DIVIDER_N;
+        
+        // -- Allocate the DMA buffers, as many rows each as will fit
+        int row_bytes = 32 * gNumColorChannels * gPulsesPerBit;
+        gRowsPerBuffer = FASTLED_ESP32_I2S_ROWS_PER_DMA_BUFFER;
+        if (gRowsPerBuffer * row_bytes > MAX_DMA_BUFFER_BYTES) gRowsPerBuffer = MAX_DMA_BUFFER_BYTES / row_bytes;
+        if (gRowsPerBuffer < 1) gRowsPerBuffer = 1;
+        if (gRowsPerBuffer * row_bytes != gDMABufferBytes) {
+            for (int i = 0; i < NUM_DMA_BUFFERS; i++) {
+                if (dmaBuffers[i]) {
+                    heap_caps_free(dmaBuffers[i]->buffer);
+                    heap_caps_free(dmaBuffers[i]);
+                }
+                dmaBuffers[i] = allocateDMABuffer(gRowsPerBuffer * row_bytes);
+            }
+            gDMABufferBytes = gRowsPerBuffer * row_bytes;
+            
+            // -- Arrange them as a circularly linked list
+            for (int i = 0; i < NUM_DMA_BUFFERS; i++) {
+                dmaBuffers[i]->descriptor.qe.stqe_next = &(dmaBuffers[(i + 1) % NUM_DMA_BUFFERS]->descriptor);
+            }
+        }
+        
+        gTimingsChanged = false;
+    }
+    
     /** Clear DMA buffer
      *
      *  Yves' clever trick: initialize the bits that we know must be 0
-     *  or 1 regardless of what bit they encode.
+     *  or 1 regardless of what bit they encode. The leading ones of the
+     *  white channel depend on which strips are RGBW, so fillBuffer
+     *  writes those.
      */
     static void empty( uint32_t *buf)
     {
-        for(int i=0;i<8*NUM_COLOR_CHANNELS;i++)
+        for(int i=0;i<8*gNumColorChannels*gRowsPerBuffer;i++)
         {
+            // -- i counts bits across all the rows of the buffer
+            int bitnum=i%(8*gNumColorChannels);
             int offset=gPulsesPerBit*i;
-            for(int j=0;j<ones_for_zero;j++)
-                buf[offset+j]=0xffffffff;
+            for(int j=0;j<gDataStart;j++)
+                buf[offset+j]=(bitnum < 8*3) ? gLeadMask[j] : 0;
             
-            for(int j=ones_for_one;j<gPulsesPerBit;j++)
+            for(int j=gDataEnd;j<gPulsesPerBit;j++)
                 buf[offset+j]=0;
         }
     }
@@ -577,18 +752,52 @@ protected:
         // -- The last call to showPixels is the one responsible for doing
         //    all of the actual work
         if (gNumStarted == gNumControllers) {
-            empty((uint32_t*)dmaBuffers[0]->buffer);
-            empty((uint32_t*)dmaBuffers[1]->buffer);
+            // -- Four color channels per led if any strip is RGBW
+            gRgbwMask = 0;
+            for (int i = 0; i < gNumControllers; i++) {
+                if (gControllers[i]->isRgbw()) gRgbwMask |= (1 << (i+8));
+            }
+            int num_color_channels = gRgbwMask ? 4 : 3;
+            if (num_color_channels != gNumColorChannels) {
+                gNumColorChannels = num_color_channels;
+                gTimingsChanged = true;
+            }
+
+            // -- New controllers, or a different row size? Work out the
+            //    timing and the DMA buffers again
+            if (gTimingsChanged) i2sSetTiming();
+
+            for (int i = 0; i < NUM_DMA_BUFFERS; i++) {
+                dmaBuffers[i]->descriptor.length = gRowsPerBuffer * 32 * gNumColorChannels * gPulsesPerBit;
+            }
+
+            // -- Longest strips first
+            buildSchedule();
+
+#if FASTLED_ESP32_I2S_PRETRANSPOSE == 1
+            // -- Scale and transpose everything now, out of the interrupt handler
+            prepareFrame();
+#endif
+
+            for (int i = 0; i < NUM_DMA_BUFFERS; i++) {
+                empty((uint32_t*)dmaBuffers[i]->buffer);
+            }
             gCurBuffer = 0;
             gDoneFilling = false;
+            gLastBuffer = 0;
             
-            // -- Prefill both buffers
-            fillBuffer();
-            fillBuffer();
+            // -- Prefill all the buffers
+            for (int i = 0; i < NUM_DMA_BUFFERS; i++) {
+                fillBuffer();
+            }
             
             // -- Make sure it's been at least 50ms since last show
             mWait.wait();
 
+#if FASTLED_ESP32_TRACE == 1
+            gLastFill = __clock_cycles();
+            FASTLED_TRACE(FASTLED_TRACE_CHANNEL_START, 0, 0);
+#endif
             i2sStart();
             
             // -- Wait here while the rest of the data is sent. The interrupt handler
@@ -611,10 +820,39 @@ protected:
     {
         if (i2s->int_st.out_eof) {
             i2s->int_clr.val = i2s->int_raw.val;
-            
-            if ( ! gDoneFilling) {
-                fillBuffer();
-            } else {
+
+#if FASTLED_ESP32_TRACE == 1
+            uint32_t refill_start = __clock_cycles();
+            FASTLED_TRACE(FASTLED_TRACE_REFILL_START, 0, refill_start - gLastFill);
+            gLastFill = refill_start;
+#endif
+            // -- Which buffer the DMA just reported finished
+            uintptr_t finished_desc = i2s->out_eof_des_addr;
+            int finished = -1;
+            for (int i = 0; i < NUM_DMA_BUFFERS; i++) {
+                if ((uintptr_t) &(dmaBuffers[i]->descriptor) == finished_desc) finished = i;
+            }
+
+            // -- Refill every buffer the DMA has finished since the last
+            //    interrupt, oldest first, up to that one. If it is the one
+            //    just before gCurBuffer, this interrupt came in after an
+            //    earlier one had already refilled it: nothing to do.
+            //    Once the last buffer with data in it has gone out, we're done.
+            bool done = false;
+            if (finished >= 0 && finished != (gCurBuffer + NUM_DMA_BUFFERS - 1) % NUM_DMA_BUFFERS) {
+                int cur;
+                do {
+                    cur = gCurBuffer;
+                    if (gDoneFilling && cur == gLastBuffer) done = true;
+                    fillBuffer();
+                } while (cur != finished);
+            }
+#if FASTLED_ESP32_TRACE == 1
+            FASTLED_TRACE(FASTLED_TRACE_REFILL_END, 0, __clock_cycles() - refill_start);
+#endif
+
+            if (done) {
+                FASTLED_TRACE(FASTLED_TRACE_CHANNEL_DONE, 0, 0);
                 portBASE_TYPE HPTaskAwoken = 0;
                 xSemaphoreGiveFromISR(gTX_sem, &HPTaskAwoken);
                 if(HPTaskAwoken == pdTRUE) portYIELD_FROM_ISR();
@@ -622,76 +860,278 @@ protected:
         }
     }
     
+#if FASTLED_ESP32_I2S_PRETRANSPOSE == 1
+    /** Prepare the frame
+     *
+     *  Load, transpose and mask every row of the frame into gFrameBits,
+     *  so that fillBuffer only has to expand them. If the buffer can't
+     *  be allocated, gFrameBits is left NULL and fillBuffer loads the
+     *  rows itself.
+     */
+    static void prepareFrame()
+    {
+        // -- As many rows as the longest strip
+        int rows = gNumControllers ? gLaneLength[gLaneOrder[0]] : 0;
+
+        int row_words = ROW_WORDS(gNumColorChannels);
+        int words = rows * row_words;
+        if (words > gFrameBitsSize) {
+            heap_caps_free(gFrameBits);
+            gFrameBits = NULL;
+#if FASTLED_ESP32_I2S_PRETRANSPOSE_PSRAM == 1
+            gFrameBits = (uint32_t *) heap_caps_malloc(words * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+#endif
+            if (gFrameBits == NULL) {
+                gFrameBits = (uint32_t *) heap_caps_malloc(words * sizeof(uint32_t), MALLOC_CAP_8BIT);
+            }
+            gFrameBitsSize = gFrameBits ? words : 0;
+            if (gFrameBits == NULL) return;
+        }
+
+        uint32_t * row = gFrameBits;
+        for (int i = 0; i < rows; i++) {
+            loadRow(row);
+            row += row_words;
+        }
+        gFrameRows = rows;
+        gFrameRow = 0;
+    }
+#endif
+
+    /** Build the schedule
+     *
+     *  Sort the controllers by the length of their strips, longest
+     *  first (see gLaneOrder), and start them all off.
+     */
+    static void buildSchedule()
+    {
+        gActiveLanes = 0;
+        gActiveMask = 0;
+        for (int i = 0; i < gNumControllers; i++) {
+            ClocklessController * pController = static_cast<ClocklessController*>(gControllers[i]);
+            int len = pController->mPixels->size();
+            gLaneLength[i] = len;
+
+            // -- Insertion sort: there are only up to 24 of them
+            int k = i;
+            while (k > 0 && gLaneLength[gLaneOrder[k-1]] < len) {
+                gLaneOrder[k] = gLaneOrder[k-1];
+                k--;
+            }
+            gLaneOrder[k] = i;
+
+            if (len > 0) {
+                gActiveLanes++;
+                gActiveMask |= (1 << (i+8));
+            }
+        }
+        gRowsLoaded = 0;
+    }
+
     /** Fill DMA buffer
      *
-     *  This is where the real work happens: take a row of pixels (one
-     *  from each strip), transpose and encode the bits, and store
-     *  them in the DMA buffer for the I2S peripheral to read.
+     *  Fill the next buffer in the ring with the next gRowsPerBuffer
+     *  rows. Once the strips run out of data, the rest of it is set to
+     *  all zeros, which just keeps the lines low until we stop.
      */
     static IRAM_ATTR void fillBuffer()
     {
-        // -- Alternate between buffers
-        volatile uint32_t * buf = (uint32_t *) dmaBuffers[gCurBuffer]->buffer;
+        // -- Go around the ring
+        int cur = gCurBuffer;
+        volatile uint32_t * buf = (uint32_t *) dmaBuffers[cur]->buffer;
         gCurBuffer = (gCurBuffer + 1) % NUM_DMA_BUFFERS;
-        
-        // -- Get the requested pixel from each controller. Store the
-        //    data for each color channel in a separate array.
-        uint32_t has_data_mask = 0;
-        for (int i = 0; i < gNumControllers; i++) {
+
+        int row_pulses = 8 * gNumColorChannels * gPulsesPerBit;
+        for (int r = 0; r < gRowsPerBuffer; r++) {
+            if ( ! gDoneFilling && fillRow(buf)) {
+                gLastBuffer = cur;
+            } else {
+                gDoneFilling = true;
+                for (int i = 0; i < row_pulses; i++) buf[i] = 0;
+            }
+            buf += row_pulses;
+        }
+    }
+
+    /** Fill one row
+     *
+     *  This is where the real work happens: take a row of pixels (one
+     *  from each strip), transpose and encode the bits, and store
+     *  them in the DMA buffer for the I2S peripheral to read. With a
+     *  pre-transposed frame the row is already transposed. Returns
+     *  false if none of the strips has data left.
+     */
+    static IRAM_ATTR bool fillRow(volatile uint32_t * buf)
+    {
+#if FASTLED_ESP32_I2S_PRETRANSPOSE == 1
+        if (gFrameBits) {
+            if (gFrameRow == gFrameRows) return false;
+            expandRow(buf, gFrameBits + gFrameRow * ROW_WORDS(gNumColorChannels));
+            gFrameRow++;
+            return true;
+        }
+#endif
+
+        uint32_t row[ROW_WORDS(NUM_COLOR_CHANNELS)];
+        if (loadRow(row) == 0) return false;
+
+        expandRow(buf, row);
+        return true;
+    }
+
+    /** Load a row
+     *
+     *  Get the next pixel from each controller, transpose the bits and
+     *  store them in row (see ROW_WORDS). Returns the mask of the
+     *  strips that still had data, 0 when they are all done.
+     */
+    static IRAM_ATTR uint32_t loadRow(uint32_t * row)
+    {
+        // -- Drop the strips that are done. They are the shortest, so
+        //    they are at the end of the schedule.
+        while (gActiveLanes > 0 && gLaneLength[gLaneOrder[gActiveLanes-1]] <= gRowsLoaded) {
+            gActiveLanes--;
+            gActiveMask &= ~(1 << (gLaneOrder[gActiveLanes]+8));
+        }
+
+        // -- Get the next pixel from each controller that still has one.
+        //    Store the data for each color channel in a separate array.
+        //    The columns of the strips that are done keep their old
+        //    pixel, which the data mask takes out.
+        for (int k = 0; k < gActiveLanes; k++) {
             // -- Store the pixels in reverse controller order starting at index 23
             //    This causes the bits to come out in the right position after we
             //    transpose them.
-            int bit_index = 23-i;
-            ClocklessController * pController = static_cast<ClocklessController*>(gControllers[i]);
-            if (pController->mPixels->has(1)) {
-                gPixelRow[0][bit_index] = pController->mPixels->loadAndScale0();
-                gPixelRow[1][bit_index] = pController->mPixels->loadAndScale1();
-                gPixelRow[2][bit_index] = pController->mPixels->loadAndScale2();
-                pController->mPixels->advanceData();
-                pController->mPixels->stepDithering();
-                
-                // -- Record that this controller still has data to send
-                has_data_mask |= (1 << (i+8));
-            }
+            int i = gLaneOrder[k];
+            gLoadPixel[i](gControllers[i], 23-i);
         }
-        
-        // -- None of the strips has data? We are done.
-        if (has_data_mask == 0) {
-            gDoneFilling = true;
-            return;
-        }
-        
-        // -- Transpose and encode the pixel data for the DMA buffer
-        // int buf_index = 0;
-        for (int channel = 0; channel < NUM_COLOR_CHANNELS; channel++) {
+        gRowsLoaded++;
+
+        uint32_t has_data_mask = gActiveMask;
+        row[0] = has_data_mask;
+        if (has_data_mask == 0) return 0;
+
+        uint32_t * bits = row + 1;
+        for (int channel = 0; channel < gNumColorChannels; channel++) {
             
             // -- Tranpose each array: all the bit 7's, then all the bit 6's, ...
-            transpose32(gPixelRow[channel], gPixelBits[channel][0] );
+            transpose32(gPixelRow[channel], gPixelBits[channel][0], has_data_mask);
+
+            // -- Only the RGBW strips send the white channel
+            uint32_t channel_mask = (channel < 3) ? has_data_mask : (has_data_mask & gRgbwMask);
             
-            //print("Channel: "); print(channel); print(" ");
             for (int bitnum = 0; bitnum < 8; bitnum++) {
-                uint8_t * row = (uint8_t *) (gPixelBits[channel][bitnum]);
-                uint32_t bit = (row[0] << 24) | (row[1] << 16) | (row[2] << 8) | row[3];
-                
-               /* SZG: More general, but too slow:
-                    for (int pulse_num = 0; pulse_num < gPulsesPerBit; pulse_num++) {
-                        buf[buf_index++] = has_data_mask & ( (bit & gOneBit[pulse_num]) | (~bit & gZeroBit[pulse_num]) );
-                     }
-               */
-
-                // -- Only fill in the pulses that are different between the "0" and "1" encodings
-                for(int pulse_num = ones_for_zero; pulse_num < ones_for_one; pulse_num++) {
-                    buf[bitnum*gPulsesPerBit+channel*8*gPulsesPerBit+pulse_num] = has_data_mask & bit;
-                }
+                uint8_t * bit_row = (uint8_t *) (gPixelBits[channel][bitnum]);
+                uint32_t bit = (bit_row[0] << 24) | (bit_row[1] << 16) | (bit_row[2] << 8) | bit_row[3];
+                *bits++ = channel_mask & bit;
+            }
+        }
+
+        return has_data_mask;
+    }
+
+    /** Load a pixel
+     *
+     *  Load the next pixel of a controller of this type into column
+     *  bit_index of gPixelRow. The schedule says whether it has one.
+     *  Each controller uses its own (see gLoadPixel), so that each
+     *  strip gets its own color order.
+     */
+    static IRAM_ATTR void loadPixel(CLEDController * controller, int bit_index)
+    {
+        ClocklessController * pController = static_cast<ClocklessController*>(controller);
+
+        if (pController->isRgbw()) {
+            gPixelRow[3][bit_index] = pController->mPixels->loadAndScaleRGBW(pController->getWhite(),
+                gPixelRow[0][bit_index], gPixelRow[1][bit_index], gPixelRow[2][bit_index]);
+        } else {
+            gPixelRow[0][bit_index] = pController->mPixels->loadAndScale0();
+            gPixelRow[1][bit_index] = pController->mPixels->loadAndScale1();
+            gPixelRow[2][bit_index] = pController->mPixels->loadAndScale2();
+            gPixelRow[3][bit_index] = 0;
+        }
+        pController->mPixels->advanceData();
+        pController->mPixels->stepDithering();
+    }
+
+    /** Expand a row
+     *
+     *  Turn each of the parallel bits of a loaded row into the pulses
+     *  that encode it, in the DMA buffer. Only the pulses that differ
+     *  between the "0" and "1" encodings are written; empty() set the
+     *  others. The stores don't need to be volatile (which costs a
+     *  memw each on the ESP32): the DMA doesn't get to this buffer
+     *  until we are done with it.
+     */
+    static IRAM_ATTR void expandRow(volatile uint32_t * vbuf, const uint32_t * row)
+    {
+        uint32_t * buf = (uint32_t *) vbuf;
+        const uint32_t * bits = row + 1;
+
+        // -- Strips of different chips: go by the masks
+        if ( ! gSameTiming || gDataStart != ONES_FOR_ZERO || gDataEnd != ONES_FOR_ONE || gPulsesPerBit != PULSES_PER_BIT) {
+            expandRowMixed(buf, row);
+            return;
+        }
+
+        const uint32_t * end = bits + 8 * 3;
+        while (bits != end) {
+            buf = expandBit(buf, *bits++);
+        }
+
+        // -- White: the leading ones too, for the RGBW strips only
+        if (gNumColorChannels == 4) {
+            uint32_t white_mask = row[0] & gRgbwMask;
+            end = bits + 8;
+            while (bits != end) {
+                for (int i = 0; i < ONES_FOR_ZERO; i++) buf[i] = white_mask;
+                buf = expandBit(buf, *bits++);
+            }
+        }
+    }
+
+    /** Expand a row, strips of different chips
+     *
+     *  The same as expandRow, but each pulse is the strips that are
+     *  high there anyway plus the bit for the strips that send it there.
+     */
+    static IRAM_ATTR void expandRowMixed(uint32_t * buf, const uint32_t * row)
+    {
+        uint32_t white_mask = row[0] & gRgbwMask;
+        const uint32_t * bits = row + 1;
+
+        for (int n = 0; n < 8 * gNumColorChannels; n++) {
+            uint32_t bit = *bits++;
+            if (n < 8 * 3) {
+                for (int k = gDataStart; k < gDataEnd; k++) buf[k] = gLeadMask[k] | (bit & gDataMask[k]);
+            } else {
+                for (int k = 0; k < gDataStart; k++) buf[k] = gLeadMask[k] & white_mask;
+                for (int k = gDataStart; k < gDataEnd; k++) buf[k] = (gLeadMask[k] & white_mask) | (bit & gDataMask[k]);
             }
+            buf += gPulsesPerBit;
         }
     }
+
+    /** Expand one bit
+     *
+     *  Store the bit in its pulses ONES_FOR_ZERO to ONES_FOR_ONE, and
+     *  return where the next bit starts.
+     */
+    __attribute__ ((always_inline)) inline static uint32_t * expandBit(uint32_t * buf, uint32_t bit)
+    {
+        for (int i = ONES_FOR_ZERO; i < ONES_FOR_ONE; i++) buf[i] = bit;
+        return buf + PULSES_PER_BIT;
+    }
     
-    static void transpose32(uint8_t * pixels, uint8_t * bits)
+    /** Transpose the 24 strips' bytes in groups of 8, skipping the
+     *  groups that have no strips with data in mask (their bits get
+     *  masked out anyway)
+     */
+    static void transpose32(uint8_t * pixels, uint8_t * bits, uint32_t mask)
     {
-        transpose8rS32(& pixels[0],  1, 4, & bits[0]);
-        transpose8rS32(& pixels[8],  1, 4, & bits[1]);
-        transpose8rS32(& pixels[16], 1, 4, & bits[2]);
+        if (mask & 0xFF000000) transpose8rS32(& pixels[0],  1, 4, & bits[0]);
+        if (mask & 0x00FF0000) transpose8rS32(& pixels[8],  1, 4, & bits[1]);
+        if (mask & 0x0000FF00) transpose8rS32(& pixels[16], 1, 4, & bits[2]);
         //transpose8rS32(& pixels[24], 1, 4, & bits[3]);  Can only use 24 bits
     }
     
@@ -730,7 +1170,7 @@ protected:
         i2sReset();
         //println(dmaBuffers[0]->sampleCount());
         i2s->lc_conf.val=I2S_OUT_DATA_BURST_EN | I2S_OUTDSCR_BURST_EN | I2S_OUT_DATA_BURST_EN;
-        i2s->out_link.addr = (uint32_t) & (dmaBuffers[0]->descriptor);
+        i2s->out_link.addr = (uintptr_t) & (dmaBuffers[0]->descriptor);
         i2s->out_link.start = 1;
         ////vTaskDelay(5);
         i2s->int_clr.val = i2s->int_raw.val;
@@ -4,28 +4,70 @@
 #include "FastLED.h"
 
 //static const char *TAG = "FastLED";
+#ifndef FASTLED_RMT_EMULATOR
 #include "esp_idf_version.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#endif
 
 
 // -- Forward reference
 class ESP32RMTController;
 
+// -- Translators for the built-in driver, one per channel
+//    The driver does not pass a context to the translator (before
+//    IDF 4.3), so each channel gets its own function that looks up
+//    the controller currently on that channel.
+template <int CHANNEL>
+static void IRAM_ATTR translateOnChannel(const void * src, rmt_item32_t * dest, size_t src_size,
+                                         size_t wanted_num, size_t * translated_size, size_t * item_num)
+{
+    ESP32RMTController::translate(CHANNEL, src, dest, src_size, wanted_num, translated_size, item_num);
+}
+
+static sample_to_rmt_t gTranslators[8] = {
+    translateOnChannel<0>, translateOnChannel<1>, translateOnChannel<2>, translateOnChannel<3>,
+    translateOnChannel<4>, translateOnChannel<5>, translateOnChannel<6>, translateOnChannel<7>
+};
+
 // -- Array of all controllers
 //    This array is filled at the time controllers are registered 
 //    (Usually when the sketch calls addLeds)
 static ESP32RMTController * gControllers[FASTLED_RMT_MAX_CONTROLLERS];
 
+// -- Order in which controllers are started in the current frame
+//    Retried controllers are queued again, so leave room for them
+static ESP32RMTController * gQueue[FASTLED_RMT_MAX_CONTROLLERS * (1 + FASTLED_RMT_MAX_RETRIES)];
+
 // -- Current set of active controllers, indexed by the RMT
 //    channel assigned to them.
 static ESP32RMTController * gOnChannel[FASTLED_RMT_MAX_CHANNELS];
 
+// -- Channel layout, made by init()
+//    Channel i uses RMT channel gChannelRMT[i] and gChannelBlocks[i]
+//    memory blocks starting at that channel's own block
+static int           gNumChannels = 0;
+static rmt_channel_t gChannelRMT[FASTLED_RMT_MAX_CHANNELS];
+static int           gChannelBlocks[FASTLED_RMT_MAX_CHANNELS];
+
 static int gNumControllers = 0;
 static int gNumStarted = 0;
 static int gNumDone = 0;
 static int gNext = 0;
+static int gNumQueued = 0;
+
+// -- Protects the queue and channel table, which are updated both by
+//    the task calling show() and by the interrupt handler
+static portMUX_TYPE gRMT_mux = portMUX_INITIALIZER_UNLOCKED;
 
 static intr_handle_t gRMT_intr_handle = NULL;
 
+// -- Frame makespan, predicted by buildSchedule() and measured
+//    from the first tx_start to the last doneOnChannel
+static uint32_t gPredictedMakespan = 0;
+static uint32_t gActualMakespan = 0;
+static int64_t  gFrameStart = 0;
+
 // -- Global semaphore for the whole show process
 //    Semaphore is not given until all data has been sent
 static xSemaphoreHandle gTX_sem = NULL;
@@ -33,7 +75,36 @@ static xSemaphoreHandle gTX_sem = NULL;
 // -- Make sure we can't call show() too quickly (fastled library)
 CMinWait<55>   gWait;
 
-static bool gInitialized = false;
+// -- False until init() has laid out the channels, and again whenever a
+//    controller is added or asks for a different number of memory blocks
+static bool gLayoutValid = false;
+
+// -- Asynchronous show: the last showPixels() returns as soon as the
+//    transmission has been started. gTX_sem stays taken until the
+//    interrupt handler gives it back at the end of the frame.
+static bool gAsync = false;
+
+// -- Worker on the other core for parallel conversion
+//    The task that calls show() posts jobs to gEncodeQueue; the worker
+//    gives gEncodeDone once for each job it finishes
+typedef struct {
+    ESP32RMTController::EncodeFn fn;
+    void * arg;
+} fastled_encode_job_t;
+
+static QueueHandle_t     gEncodeQueue = NULL;
+static xSemaphoreHandle  gEncodeDone = NULL;
+static int               gEncodePending = 0;
+
+// -- Bytes of pixel data converted on each core so far this frame
+static int gEncodeLocal = 0;
+static int gEncodeRemote = 0;
+
+#if FASTLED_ESP32_FLASH_LOCK == 1
+// -- Flash lock held while a frame is sent, released by the task
+//    when it waits for the transmission
+static bool gFlashLocked = false;
+#endif
 
 /*
 ** general DRAM system for printing during faster IRQs
@@ -204,13 +275,29 @@ static inline void fastled_set_mem_owner(rmt_channel_t channel, uint8_t owner)
 
 
 ESP32RMTController::ESP32RMTController(int DATA_PIN, int T1, int T2, int T3)
-    : mPixelData(0), 
+    : mChannel(0),
+      mMemBlocks(MEM_BLOCK_NUM),
+      mPulsesPerFill(PULSES_PER_FILL),
+      mPixelData(0), 
+      mPixelDataBack(0),
       mSize(0), 
+      mSizeBack(0),
+      mCapacity(0),
+      mCapacityBack(0),
       mCur(0), 
       mWhichHalf(0),
-      mBuffer(0),
-      mBufferSize(0),
-      mCurPulse(0)
+      mBailedOut(false),
+      mRetryPending(false),
+      mFrameRetries(0),
+      mBailouts(0),
+      mRetries(0),
+      mFrameHash(0),
+      mHashValid(false),
+      mSkip(false),
+      mFramesSkipped(0),
+      mSkips(0),
+      mTransmitStart(0),
+      mTransmitTime(0)
 {
     // -- Precompute rmt items corresponding to a zero bit and a one bit
     //    according to the timing values given in the template instantiation
@@ -228,11 +315,15 @@ ESP32RMTController::ESP32RMTController(int DATA_PIN, int T1, int T2, int T3)
     mZero.level1 = 0;
     mZero.duration1 = ESP_TO_RMT_CYCLES(T2+T3); // TO_RMT_CYCLES(T2 + T3);
 
+    initNibbleItems();
+
     gControllers[gNumControllers] = this;
     gNumControllers++;
+    gLayoutValid = false;
 
     // -- Expected number of CPU cycles between buffer fills
-    mCyclesPerFill = (T1 + T2 + T3) * PULSES_PER_FILL;
+    mCyclesPerBit = T1 + T2 + T3;
+    mCyclesPerFill = mCyclesPerBit * PULSES_PER_FILL;
 
     // -- If there is ever an interval greater than 1.75 times
     //    the expected time, then bail out.
@@ -241,23 +332,197 @@ ESP32RMTController::ESP32RMTController(int DATA_PIN, int T1, int T2, int T3)
     mPin = gpio_num_t(DATA_PIN);
 }
 
+// -- Build the nibble lookup table
+//    Entry n holds the RMT items for the four bits of n, most
+//    significant bit first, which is the order they go out on the wire.
+void ESP32RMTController::initNibbleItems()
+{
+    for (int n = 0; n < 16; n++) {
+        for (int bit = 0; bit < 4; bit++) {
+            mNibbleItems[n][bit] = (n & (0x8 >> bit)) ? mOne.val : mZero.val;
+        }
+    }
+}
+
 // -- Get or create the buffer for the pixel data
 //    We can't allocate it ahead of time because we don't have
 //    the PixelController object until show is called.
+//    Once asynchronous show has been used the data is always loaded
+//    into the back buffer, because the front buffer may still be
+//    on the wire. A buffer too small for this frame (the strip got
+//    longer, or went to four bytes per led) is allocated again.
 uint32_t * ESP32RMTController::getPixelBuffer(int size_in_bytes)
 {
-    if (mPixelData == 0) {
-        mSize = ((size_in_bytes-1) / sizeof(uint32_t)) + 1;
-        mPixelData = (uint32_t *) calloc( mSize, sizeof(uint32_t));
+    int words = ((size_in_bytes-1) / sizeof(uint32_t)) + 1;
+
+    if (mPixelData == 0 || (mPixelDataBack == 0 && words > mCapacity)) {
+        free(mPixelData);
+        mPixelData = (uint32_t *) calloc( words, sizeof(uint32_t));
+        mCapacity = words;
+    }
+    if ((gAsync && mPixelDataBack == 0) || (mPixelDataBack && words > mCapacityBack)) {
+        free(mPixelDataBack);
+        mPixelDataBack = (uint32_t *) calloc( words, sizeof(uint32_t));
+        mCapacityBack = words;
     }
+
+    if (mPixelDataBack) {
+        mSizeBack = words;
+        return mPixelDataBack;
+    }
+    mSize = words;
     return mPixelData;
 }
 
+// -- Swap the front and back pixel buffers
+//    Only called once the previous frame has been sent
+void ESP32RMTController::swapPixelBuffers()
+{
+    if (mPixelDataBack) {
+        uint32_t * tmp = mPixelData;
+        mPixelData = mPixelDataBack;
+        mPixelDataBack = tmp;
+
+        int size = mSize;
+        mSize = mSizeBack;
+        mSizeBack = size;
+
+        int capacity = mCapacity;
+        mCapacity = mCapacityBack;
+        mCapacityBack = capacity;
+    }
+}
+
+// -- Record the hash of the frame just loaded
+//    The frame is skipped if it matches the last one, unless the strip
+//    is due for a refresh. The hash is invalidated when a frame is cut
+//    short, so that the strip gets the whole frame again.
+void ESP32RMTController::setFrameHash(uint32_t hash)
+{
+    mSkip = mHashValid && (hash == mFrameHash) && (mFramesSkipped < FASTLED_RMT_REFRESH_INTERVAL);
+    if (mSkip) {
+        mFramesSkipped++;
+        mSkips++;
+    } else {
+        mFramesSkipped = 0;
+    }
+    mFrameHash = hash;
+    mHashValid = true;
+}
+
+// -- Worker task for parallel conversion
+//    Runs the jobs posted by encodeOnOtherCore(), one at a time
+static void encodeTask(void * arg)
+{
+    fastled_encode_job_t job;
+    for (;;) {
+        if (xQueueReceive(gEncodeQueue, &job, portMAX_DELAY) == pdTRUE) {
+            job.fn(job.arg);
+            xSemaphoreGive(gEncodeDone);
+        }
+    }
+}
+
+// -- Decide where this controller's data is converted
+//    Greedy balance by size: each controller goes to whichever core has
+//    converted fewer bytes so far this frame. The last controller always
+//    stays on this core, which would otherwise just wait for the worker.
+bool ESP32RMTController::claimOtherCore(int size_in_bytes)
+{
+    if (gEncodeQueue == NULL) {
+        gEncodeQueue = xQueueCreate(FASTLED_RMT_MAX_CONTROLLERS, sizeof(fastled_encode_job_t));
+        gEncodeDone = xSemaphoreCreateCounting(FASTLED_RMT_MAX_CONTROLLERS, 0);
+        xTaskCreatePinnedToCore(encodeTask, "fastled_encode", FASTLED_RMT_ENCODE_STACK_SIZE, NULL,
+                                uxTaskPriorityGet(NULL), NULL, 1 - xPortGetCoreID());
+    }
+
+    if (gNumStarted == 0) {
+        gEncodeLocal = 0;
+        gEncodeRemote = 0;
+    }
+
+    if ((gNumStarted < gNumControllers - 1) && (gEncodeRemote < gEncodeLocal)) {
+        gEncodeRemote += size_in_bytes;
+        return true;
+    }
+
+    gEncodeLocal += size_in_bytes;
+    return false;
+}
+
+// -- Hand a conversion job to the worker on the other core
+void ESP32RMTController::encodeOnOtherCore(EncodeFn fn, void * arg)
+{
+    fastled_encode_job_t job = { fn, arg };
+    gEncodePending++;
+    xQueueSend(gEncodeQueue, &job, portMAX_DELAY);
+}
+
+// -- Wait for the worker to finish the jobs handed to it this frame
+void ESP32RMTController::waitForEncode()
+{
+    while (gEncodePending > 0) {
+        xSemaphoreTake(gEncodeDone, portMAX_DELAY);
+        gEncodePending--;
+    }
+}
+
+// -- Select asynchronous show
+//    Not with FASTLED_ESP32_FLASH_LOCK: the lock has to be released by
+//    the task that took it, and with an asynchronous show that task
+//    would only do so when it next waits, so a loop of showAsync()
+//    calls would keep flash locked for good.
+void ESP32RMTController::setAsync(bool async)
+{
+#if FASTLED_ESP32_FLASH_LOCK == 1
+    async = false;
+#endif
+    gAsync = async;
+}
+
+bool ESP32RMTController::isAsync()
+{
+    return gAsync;
+}
+
+// -- Wait for the current transmission (if any) to finish
+//    Safe to call at any time, including before the first show
+void ESP32RMTController::waitForShow()
+{
+    if (gTX_sem == NULL) return;
+
+    xSemaphoreTake(gTX_sem, portMAX_DELAY);
+    xSemaphoreGive(gTX_sem);
+
+#if FASTLED_ESP32_FLASH_LOCK == 1
+    if (gFlashLocked) {
+        // -- Release the lock on flash operations
+        spi_flash_op_unlock();
+        gFlashLocked = false;
+    }
+#endif
+}
+
+// -- Memory blocks for this controller
+void ESP32RMTController::setMemBlocks(int blocks)
+{
+    if (blocks != mMemBlocks) {
+        mMemBlocks = blocks;
+        gLayoutValid = false;
+    }
+}
+
+int ESP32RMTController::getMemBlocks() const
+{
+    return mMemBlocks;
+}
+
 // -- Initialize RMT subsystem
-//    This only needs to be done once
+//    Done before the first frame, and redone before any frame that
+//    follows a change to the controllers or their memory blocks
 void ESP32RMTController::init()
 {
-    if (gInitialized) return;
+    if (gLayoutValid) return;
 
     // -- Create a semaphore to block execution until all the controllers are done
     if (gTX_sem == NULL) {
@@ -265,12 +530,53 @@ void ESP32RMTController::init()
         xSemaphoreGive(gTX_sem);
     }
 
-    for (int i = 0; i < FASTLED_RMT_MAX_CHANNELS; i++) {
+    // -- An asynchronous frame may still be sending on the old layout
+    waitForShow();
+
+    // -- The built-in driver is installed per RMT channel, which may
+    //    not line up with the new layout
+    if (FASTLED_RMT_BUILTIN_DRIVER) {
+        for (int i = 0; i < gNumChannels; i++) {
+            ESP_ERROR_CHECK( rmt_driver_uninstall(gChannelRMT[i]) );
+        }
+    }
+
+    // -- Lay out the channels. Each controller, largest request first,
+    //    gets a channel with the blocks it asked for, while there are
+    //    blocks and channels left. The first channel is the largest, so
+    //    every controller fits on at least one of them.
+    int requests[FASTLED_RMT_MAX_CONTROLLERS];
+    for (int i = 0; i < gNumControllers; i++) {
+        ESP32RMTController * pController = gControllers[i];
+        if (pController->mMemBlocks < 1) pController->mMemBlocks = 1;
+        if (pController->mMemBlocks > RMT_MEM_BLOCKS) pController->mMemBlocks = RMT_MEM_BLOCKS;
+
+        int j = i;
+        while (j > 0 && requests[j-1] < pController->mMemBlocks) {
+            requests[j] = requests[j-1];
+            j--;
+        }
+        requests[j] = pController->mMemBlocks;
+    }
+
+    gNumChannels = 0;
+    int next_block = 0;
+    for (int i = 0; (i < gNumControllers) && (gNumChannels < FASTLED_RMT_MAX_CHANNELS); i++) {
+        if (next_block + requests[i] > RMT_MEM_BLOCKS) continue;
+        gChannelRMT[gNumChannels] = rmt_channel_t(next_block);
+        gChannelBlocks[gNumChannels] = requests[i];
+        gNumChannels++;
+        next_block += requests[i];
+    }
+
+    for (int i = 0; i < gNumChannels; i++) {
 
         gOnChannel[i] = NULL;
 
-        // if you are using MEM_BLOCK_NUM, the RMT channel won't be the same as the "channel number"
-        rmt_channel_t rmt_channel = rmt_channel_t(i * MEM_BLOCK_NUM);
+        // -- A channel with more than one block uses up the channels
+        //    after it, so the RMT channel is not the same as "i"
+        rmt_channel_t rmt_channel = gChannelRMT[i];
+        int pulses_per_fill = (gChannelBlocks[i] * PULSES_PER_BLOCK) / 2;
 
         // -- RMT configuration for transmission
         // NOTE: In ESP-IDF 4.1++, there is a #define to init, but that doesn't exist
@@ -285,7 +591,7 @@ void ESP32RMTController::init()
         rmt_tx.gpio_num = gpio_num_t(0);  // The particular pin will be assigned later
 #endif
 
-        rmt_tx.mem_block_num = MEM_BLOCK_NUM; 
+        rmt_tx.mem_block_num = gChannelBlocks[i];
         rmt_tx.clk_div = DIVIDER;
         rmt_tx.tx_config.loop_en = false;
         rmt_tx.tx_config.carrier_level = RMT_CARRIER_LEVEL_LOW;
@@ -298,6 +604,10 @@ void ESP32RMTController::init()
 
         if (FASTLED_RMT_BUILTIN_DRIVER) {
             ESP_ERROR_CHECK( rmt_driver_install(rmt_channel, 0, 0) );
+
+            // -- The driver calls our translator to encode the pixel
+            //    data a piece at a time as it refills the RMT memory
+            ESP_ERROR_CHECK( rmt_translator_init(rmt_channel, gTranslators[i]) );
         } 
         else {
 
@@ -305,9 +615,9 @@ void ESP32RMTController::init()
             //    generate an interrupt. When we get this interrupt we
             //    fill the other part in preparation (like double-buffering)
 #if USE_FASTLED_RMT_FNS
-            ESP_ERROR_CHECK( fastled_set_tx_thr_intr_en(rmt_channel, true, PULSES_PER_FILL) );
+            ESP_ERROR_CHECK( fastled_set_tx_thr_intr_en(rmt_channel, true, pulses_per_fill) );
 #else
-            ESP_ERROR_CHECK( rmt_set_tx_thr_intr_en(rmt_channel, true, PULSES_PER_FILL) );
+            ESP_ERROR_CHECK( rmt_set_tx_thr_intr_en(rmt_channel, true, pulses_per_fill) );
 #endif
 
         }
@@ -326,7 +636,19 @@ void ESP32RMTController::init()
         }
     }
 
-    gInitialized = true;
+    gLayoutValid = true;
+}
+
+// -- Channel layout
+int ESP32RMTController::getNumChannels()
+{
+    return gNumChannels;
+}
+
+int ESP32RMTController::getChannelBlocks(int channel)
+{
+    if (channel < 0 || channel >= gNumChannels) return 0;
+    return gChannelBlocks[channel];
 }
 
 // -- Show this string of pixels
@@ -338,55 +660,80 @@ void ESP32RMTController::showPixels()
         // -- First controller: make sure everything is set up
         ESP32RMTController::init();
 
-#if FASTLED_ESP32_FLASH_LOCK == 1
-        // -- Make sure no flash operations happen right now
-        spi_flash_op_lock();
-#endif
+        // -- In pipelined mode the frame begins now, so that this
+        //    controller can start sending right away
+        if (FASTLED_RMT_PIPELINE_ACTIVE) {
+            beginFrame();
+        }
     }
 
     // -- Keep track of the number of strips we've seen
     gNumStarted++;
 
+    if (FASTLED_RMT_PIPELINE_ACTIVE) {
+        if (mSkip) {
+            // -- Nothing changed: count this controller as done
+            portENTER_CRITICAL(&gRMT_mux);
+            gNumDone++;
+            bool all_done = (gNumDone == gNumControllers);
+            portEXIT_CRITICAL(&gRMT_mux);
+            if (all_done) endFrame(false);
+        } else {
+            // -- Our data is ready: queue it, and start it if a channel is free
+            swapPixelBuffers();
+            enqueue();
+        }
+    }
+
     // -- The last call to showPixels is the one responsible for doing
     //    all of the actual work
     if (gNumStarted == gNumControllers) {
-        gNext = 0;
 
-        // -- This Take always succeeds immediately
-        xSemaphoreTake(gTX_sem, portMAX_DELAY);
+        // -- Reset the counters
+        gNumStarted = 0;
+
+        // -- All the pixel data must be ready before anything is sent
+        if (FASTLED_RMT_PARALLEL_ENCODE_ACTIVE) {
+            waitForEncode();
+        }
+
+        if (FASTLED_RMT_PIPELINE_ACTIVE) {
+            // -- Everything is already queued or sending
+            predictMakespan();
+        } else {
+            beginFrame();
+
+            // -- The previous frame is done: the back buffers become the
+            //    ones to send
+            for (int i = 0; i < gNumControllers; i++) {
+                gControllers[i]->swapPixelBuffers();
+            }
 
-        // -- Make sure it's been at least 50us since last show
-        // this is very conservative if you have multiple channels,
-        // arguably there should be a wait on the startnext of each LED string
-        gWait.wait();
+            // -- Decide the order the controllers go out in
+            buildSchedule();
+            gFrameStart = esp_timer_get_time();
 
-        // -- First, fill all the available channels and start them
-        int channel = 0;
-        while ( (channel < FASTLED_RMT_MAX_CHANNELS) && (gNext < gNumControllers) ) {
+            // -- If every controller was skipped, the frame is over
+            if (gNumQueued == 0) endFrame(false);
 
-            ESP32RMTController::startNext(channel);
+            // -- First, fill all the available channels and start them
+            int channel = 0;
+            while ( (channel < gNumChannels) && (gNext < gNumQueued) ) {
 
-            channel++;
+                ESP32RMTController::startNext(channel);
+
+                channel++;
+            }
         }
 
+        // -- In asynchronous mode, return while the data is sent. The
+        //    next show (or waitForShow) picks up the semaphore.
+        if (gAsync) return;
+
         // -- Wait here while the data is sent. The interrupt handler
         //    will keep refilling the RMT buffers until it is all
         //    done; then it gives the semaphore back.
-        xSemaphoreTake(gTX_sem, portMAX_DELAY);
-        xSemaphoreGive(gTX_sem);
-
-        // -- Make sure we don't call showPixels too quickly
-        gWait.mark();
-
-        // -- Reset the counters
-        gNumStarted = 0;
-        gNumDone = 0;
-        gNext = 0;
-
-#if FASTLED_ESP32_FLASH_LOCK == 1
-        // -- Release the lock on flash operations
-        spi_flash_op_unlock();
-#endif
+        waitForShow();
 
 #if FASTLED_ESP32_SHOWTIMING == 1
         // the interrupts may have dumped things to the buffer. Print it.
@@ -404,38 +751,195 @@ void ESP32RMTController::showPixels()
 
 }
 
+// -- Begin a frame
+//    Waits for the previous frame and resets the counters
+void ESP32RMTController::beginFrame()
+{
+    // -- This Take succeeds immediately unless an asynchronous
+    //    show is still sending the previous frame
+    xSemaphoreTake(gTX_sem, portMAX_DELAY);
+
+#if FASTLED_ESP32_FLASH_LOCK == 1
+    // -- Make sure no flash operations happen right now
+    if ( ! gFlashLocked) {
+        spi_flash_op_lock();
+        gFlashLocked = true;
+    }
+#endif
+
+    gNumDone = 0;
+    gNext = 0;
+    gNumQueued = 0;
+
+    // -- Make sure it's been at least 50us since last show
+    // this is very conservative if you have multiple channels,
+    // arguably there should be a wait on the startnext of each LED string
+    gWait.wait();
+
+    gFrameStart = esp_timer_get_time();
+}
+
+// -- Add this controller to the queue (pipelined mode)
+//    If a channel is idle, start the head of the queue on it. The
+//    interrupt handler may be starting queued controllers at the same
+//    time, so the queue and channel table are only touched under gRMT_mux.
+void ESP32RMTController::enqueue()
+{
+    int channel = -1;
+    ESP32RMTController * pController = NULL;
+
+    // -- Blocks asked for after the layout was made may not fit on any
+    //    channel; such a controller would never be started
+    if (mMemBlocks > gChannelBlocks[0]) mMemBlocks = gChannelBlocks[0];
+
+    portENTER_CRITICAL(&gRMT_mux);
+    gQueue[gNumQueued++] = this;
+    for (int i = 0; i < gNumChannels; i++) {
+        if (gOnChannel[i] == NULL) {
+            pController = claimNext(i);
+            if (pController) {
+                channel = i;
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&gRMT_mux);
+
+    if (pController) pController->startOnChannel(channel);
+}
+
+// -- Number of bits this controller sends per frame
+int ESP32RMTController::numBits() const
+{
+    return mSize * 32;
+}
+
+// -- Order the controllers for this frame
+//    Longest processing time first: with the controllers sorted by
+//    length, handing each one to the channel that frees up first (which
+//    is what doneOnChannel does) keeps the channels evenly loaded. The
+//    same greedy assignment is simulated here to predict the makespan.
+void ESP32RMTController::buildSchedule()
+{
+    // -- Insertion sort; stable, so equal strips keep registration order.
+    //    Skipped controllers are not queued, and count as done already.
+    gNumQueued = 0;
+    for (int i = 0; i < gNumControllers; i++) {
+        ESP32RMTController * pController = gControllers[i];
+        if (pController->mSkip) {
+            gNumDone++;
+            continue;
+        }
+        if (pController->mMemBlocks > gChannelBlocks[0]) pController->mMemBlocks = gChannelBlocks[0];
+        int j = gNumQueued++;
+        if (FASTLED_RMT_LONGEST_FIRST) {
+            uint32_t cycles = pController->numBits() * pController->mCyclesPerBit;
+            while (j > 0 && (gQueue[j-1]->numBits() * gQueue[j-1]->mCyclesPerBit) < cycles) {
+                gQueue[j] = gQueue[j-1];
+                j--;
+            }
+        }
+        gQueue[j] = pController;
+    }
+
+    predictMakespan();
+}
+
+// -- Predict the makespan of the queued controllers
+//    Each controller goes to the channel that is free first, among
+//    those with enough memory blocks for it
+void ESP32RMTController::predictMakespan()
+{
+    uint64_t channel_free[FASTLED_RMT_MAX_CHANNELS] = {0};
+    uint64_t makespan = 0;
+    for (int i = 0; i < gNumQueued; i++) {
+        int best = 0;
+        for (int c = 1; c < gNumChannels; c++) {
+            if (gChannelBlocks[c] < gQueue[i]->mMemBlocks) continue;
+            if (channel_free[c] < channel_free[best]) best = c;
+        }
+        channel_free[best] += (uint64_t) gQueue[i]->numBits() * gQueue[i]->mCyclesPerBit;
+        if (channel_free[best] > makespan) makespan = channel_free[best];
+    }
+    gPredictedMakespan = CYCLES_TO_US(makespan);
+}
+
+// -- Predicted time to send the last frame on all channels, in microseconds
+uint32_t ESP32RMTController::getPredictedMakespan()
+{
+    return gPredictedMakespan;
+}
+
+// -- Measured makespan of the last completed frame, in microseconds
+uint32_t ESP32RMTController::getActualMakespan()
+{
+    return gActualMakespan;
+}
+
 // -- Start up the next controller
 //    This method is static so that it can dispatch to the
 //    appropriate startOnChannel method of the given controller.
 void ESP32RMTController::startNext(int channel)
 {
-    if (gNext < gNumControllers) {
-        ESP32RMTController * pController = gControllers[gNext];
-        pController->startOnChannel(channel);
-        gNext++;
+    portENTER_CRITICAL_ISR(&gRMT_mux);
+    ESP32RMTController * pController = claimNext(channel);
+    portEXIT_CRITICAL_ISR(&gRMT_mux);
+
+    if (pController) pController->startOnChannel(channel);
+}
+
+// -- Take the first queued controller that fits on this channel
+//    A controller that asked for more memory blocks than the channel
+//    has is passed over; the ones before it keep their order. Returns
+//    NULL if nothing queued fits, and the channel stays idle.
+//    Called with gRMT_mux held. The controller is given its RMT
+//    channel here, before it is published in gOnChannel, so that the
+//    interrupt handler never sees it with the channel of its last frame.
+ESP32RMTController * ESP32RMTController::claimNext(int channel)
+{
+    for (int i = gNext; i < gNumQueued; i++) {
+        ESP32RMTController * pController = gQueue[i];
+        if (pController->mMemBlocks <= gChannelBlocks[channel]) {
+            for (int j = i; j > gNext; j--) {
+                gQueue[j] = gQueue[j-1];
+            }
+            gQueue[gNext++] = pController;
+
+            // -- The RMT channel and buffer size depend on the channel layout
+            pController->mChannel = channel;
+            pController->mRMT_channel = gChannelRMT[channel];
+            pController->mPulsesPerFill = (gChannelBlocks[channel] * PULSES_PER_BLOCK) / 2;
+            pController->mCyclesPerFill = pController->mCyclesPerBit * pController->mPulsesPerFill;
+            pController->mMaxCyclesPerFill = pController->mCyclesPerFill + ((pController->mCyclesPerFill * 3)/4);
+
+            // -- Store a reference to this controller, so we can get it
+            //    inside the interrupt handler
+            gOnChannel[channel] = pController;
+            return pController;
+        }
     }
+    return NULL;
 }
 
 // -- Start this controller on the given channel
 //    This function just initiates the RMT write; it does not wait
-//    for it to finish.
+//    for it to finish. claimNext has already given it the channel.
 void ESP32RMTController::startOnChannel(int channel)
 {
 
-    // -- Store a reference to this controller, so we can get it
-    //    inside the interrupt handler
-    gOnChannel[channel] = this;
-
-    // the RMT channel depends on the MEM_BLOCK
-    mRMT_channel = rmt_channel_t(channel * MEM_BLOCK_NUM);
+    FASTLED_TRACE(FASTLED_TRACE_CHANNEL_START, channel, mSize);
 
     // -- Assign the pin to this channel
     rmt_set_pin(mRMT_channel, RMT_MODE_TX, mPin);
 
+    if ( ! mRetryPending) mTransmitStart = esp_timer_get_time();
+
     if (FASTLED_RMT_BUILTIN_DRIVER) {
-        // -- Use the built-in RMT driver to send all the data in one shot
-        rmt_register_tx_end_callback(doneOnRMTChannel, (void *) channel);
-        rmt_write_items(mRMT_channel, mBuffer, mBufferSize, false);
+        // -- Use the built-in RMT driver. It encodes the pixel data
+        //    incrementally through our translator, so mPixelData must
+        //    stay untouched until the channel is done.
+        rmt_register_tx_end_callback(doneOnRMTChannel, (void *) (intptr_t) channel);
+        rmt_write_sample(mRMT_channel, (const uint8_t *) mPixelData, mSize * sizeof(uint32_t), false);
     } else {
         // -- Use our custom driver to send the data incrementally
 
@@ -446,8 +950,20 @@ void ESP32RMTController::startOnChannel(int channel)
         mCur = 0;
         mWhichHalf = 0;
 
+        // -- A retry of a bailed-out frame first holds the line low for
+        //    the reset time, so the strip latches the partial frame and
+        //    treats the resend as a new one
+        bool retry = mRetryPending;
+        mRetryPending = false;
+        mBailedOut = false;
+        if ( ! retry) mFrameRetries = 0;
+
         // -- Fill both halves of the RMT buffer (a totality of 64 bits of pixel data)
-        fillNext();
+        if (retry) {
+            fillReset();
+        } else {
+            fillNext();
+        }
         fillNext();
 
         // -- Turn on the interrupts
@@ -481,7 +997,7 @@ void ESP32RMTController::tx_start()
 // so we use the arg instead
 void ESP32RMTController::doneOnRMTChannel(rmt_channel_t channel, void * arg) 
 {
-    doneOnChannel((int) arg, (void *) 0);
+    doneOnChannel((int) (intptr_t) arg, (void *) 0);
 }
 
 // -- A controller is done 
@@ -498,27 +1014,73 @@ void ESP32RMTController::doneOnChannel(int channel, void * arg)
     //  ESP32RMTController * pController = gOnChannel[channel];
     // gpio_matrix_out(pController->mPin, 0x100, 0, 0);
 
-    gOnChannel[channel] = NULL;
-    gNumDone++;
+    FASTLED_TRACE(FASTLED_TRACE_CHANNEL_DONE, channel, 0);
 
-    if (gNumDone == gNumControllers) {
-        // -- If this is the last controller, signal that we are all done
-        if (FASTLED_RMT_BUILTIN_DRIVER) {
-            xSemaphoreGive(gTX_sem);
-        } else {
-            portBASE_TYPE HPTaskAwoken = 0;
-            xSemaphoreGiveFromISR(gTX_sem, &HPTaskAwoken);
-            if (HPTaskAwoken == pdTRUE) portYIELD_FROM_ISR();
-        }
+    ESP32RMTController * pController = gOnChannel[channel];
+
+    portENTER_CRITICAL_ISR(&gRMT_mux);
+    gOnChannel[channel] = NULL;
+    if (pController && pController->mBailedOut && (pController->mFrameRetries < FASTLED_RMT_MAX_RETRIES)) {
+        // -- The frame was cut short: send it again from the start.
+        //    It does not count as done, and goes to the back of the queue.
+        pController->mFrameRetries++;
+        pController->mRetries++;
+        pController->mRetryPending = true;
+        gQueue[gNumQueued++] = pController;
     } else {
-        // -- Otherwise, if there are still controllers waiting, then
-        //    start the next one on this channel
-        if (gNext < gNumControllers) {
-            startNext(channel);
+        // -- A frame that was cut short must not be skipped next time.
+        //    With an asynchronous show the next frame may already have
+        //    been loaded, so clear its skip flag as well.
+        if (pController && pController->mBailedOut) {
+            pController->mHashValid = false;
+            pController->mSkip = false;
         }
+        if (pController) {
+            pController->mTransmitTime = (uint32_t) (esp_timer_get_time() - pController->mTransmitStart);
+        }
+        gNumDone++;
+    }
+    bool all_done = (gNumDone == gNumControllers);
+
+    // -- Otherwise, if there are still controllers waiting, then the
+    //    next one gets this channel. It is claimed before the mux is
+    //    released: in pipelined mode enqueue() may be looking for a free
+    //    channel on the other core, and must not find this one. The
+    //    queue may also be empty for now; the channel stays idle until
+    //    showPixels() queues another controller.
+    ESP32RMTController * pNext = NULL;
+    if ( ! all_done) pNext = claimNext(channel);
+    portEXIT_CRITICAL_ISR(&gRMT_mux);
+
+    if (all_done) {
+        // -- If this is the last controller, signal that we are all done
+        endFrame(true);
+    } else if (pNext) {
+        pNext->startOnChannel(channel);
     }
 }
     
+// -- End of frame
+//    Called by whichever controller finishes last, from the interrupt
+//    handler, or from showPixels() when the remaining controllers
+//    were all skipped.
+void ESP32RMTController::endFrame(bool from_isr)
+{
+    // -- Make sure we don't call showPixels too quickly. This is
+    //    marked here, rather than in showPixels, because with an
+    //    asynchronous show no task is waiting for the end of the frame
+    gWait.mark();
+    gActualMakespan = (uint32_t) (esp_timer_get_time() - gFrameStart);
+
+    if (FASTLED_RMT_BUILTIN_DRIVER || ! from_isr) {
+        xSemaphoreGive(gTX_sem);
+    } else {
+        portBASE_TYPE HPTaskAwoken = 0;
+        xSemaphoreGiveFromISR(gTX_sem, &HPTaskAwoken);
+        if (HPTaskAwoken == pdTRUE) portYIELD_FROM_ISR();
+    }
+}
+
 // -- Custom interrupt handler
 //    This interrupt handler handles two cases: a controller is
 //    done writing its data, or a controller needs to fill the
@@ -531,7 +1093,7 @@ void IRAM_ATTR ESP32RMTController::interruptHandler(void *arg)
     uint32_t intr_st = RMT.int_st.val;
     uint8_t channel;
 
-    for (channel = 0; channel < FASTLED_RMT_MAX_CHANNELS; channel++) {
+    for (channel = 0; channel < gNumChannels; channel++) {
 
         ESP32RMTController * pController = gOnChannel[channel];
         if (pController != NULL) {
@@ -545,12 +1107,21 @@ void IRAM_ATTR ESP32RMTController::interruptHandler(void *arg)
                 // -- More to send on this channel
                 RMT.int_clr.val |= BIT(tx_next_bit);
 
+#if FASTLED_ESP32_TRACE == 1
+                uint32_t refill_start = __clock_cycles();
+                FASTLED_TRACE(FASTLED_TRACE_REFILL_START, channel, refill_start - pController->mLastFill);
+#endif
+
                 // if timing's NOT ok, have to bail
                 if (true == pController->timingOk()) {
 
                     pController->fillNext();
 
                 }
+
+#if FASTLED_ESP32_TRACE == 1
+                FASTLED_TRACE(FASTLED_TRACE_REFILL_END, channel, __clock_cycles() - refill_start);
+#endif
             } // -- Transmission is complete on this channel
             else if (intr_st & BIT(tx_done_bit)) {
 
@@ -588,6 +1159,11 @@ bool IRAM_ATTR ESP32RMTController::timingOk() {
         memorybuf_add( g_bail_str );
 #endif /* FASTLED_ESP32_SHOWTIMING == 1 */
 
+        FASTLED_TRACE(FASTLED_TRACE_BAILOUT, mChannel, mCur);
+
+        mBailedOut = true;
+        mBailouts++;
+
         // how do we bail out? It seems if we simply call rmt_tx_stop, 
         // we'll still flicker on the end. Setting mCur to mSize has the side effect
         // of triggering the other code that says "we're finished"
@@ -596,11 +1172,7 @@ bool IRAM_ATTR ESP32RMTController::timingOk() {
         mCur = mSize;
 
         // other code also set some zeros to make sure there wasn't anything bad.
-        fastled_set_mem_owner(mRMT_channel, RMT_MEM_OWNER_SW);
-        for (uint32_t j = 0; j < PULSES_PER_FILL; j++) {
-            * mRMT_mem_ptr++ = 0;
-        }
-        fastled_set_mem_owner(mRMT_channel, RMT_MEM_OWNER_HW);
+        fillEnd();
 
         return false;
     }
@@ -623,11 +1195,6 @@ void IRAM_ATTR ESP32RMTController::fillNext()
 
     if (mCur < mSize) {
 
-        // -- Get the zero and one values into local variables
-        // each one is a "rmt_item_t", which contains two values, which is very convenient
-        register uint32_t one_val = mOne.val;
-        register uint32_t zero_val = mZero.val;
-
         // -- Use locals for speed
         volatile register uint32_t * pItem =  mRMT_mem_ptr;
 
@@ -635,16 +1202,22 @@ void IRAM_ATTR ESP32RMTController::fillNext()
         fastled_set_mem_owner(mRMT_channel, RMT_MEM_OWNER_SW);
             
         // Shift bits out, MSB first, setting RMTMEM.chan[n].data32[x] to the 
-        // rmt_item32_t value corresponding to the buffered bit value
+        // rmt_item32_t value corresponding to the buffered bit value.
+        // Four bits at a time are looked up in the nibble table, so there
+        // is no branch per bit.
 
-        for (int i=0; i < PULSES_PER_FILL / 32; i++) {
+        for (int i=0; i < mPulsesPerFill / 32; i++) {
             if (mCur < mSize) {
                 register uint32_t thispixel = mPixelData[mCur];
-                for (int j = 0; j < 32; j++) {
-
-                    *pItem++ = (thispixel & 0x80000000L) ? one_val : zero_val;
+                for (int j = 0; j < 8; j++) {
+                    const uint32_t * items = mNibbleItems[thispixel >> 28];
+                    pItem[0] = items[0];
+                    pItem[1] = items[1];
+                    pItem[2] = items[2];
+                    pItem[3] = items[3];
                     // Replaces: RMTMEM.chan[mRMT_channel].data32[mCurPulse].val = val;
-                    thispixel <<= 1;
+                    pItem += 4;
+                    thispixel <<= 4;
                 }
                 mCur++;
             }
@@ -672,46 +1245,123 @@ void IRAM_ATTR ESP32RMTController::fillNext()
 
     } else {
         // -- No more data; signal to the RMT we are done
-        fastled_set_mem_owner(mRMT_channel, RMT_MEM_OWNER_SW);
-        for (uint32_t j = 0; j < PULSES_PER_FILL; j++) {
-            * mRMT_mem_ptr++ = 0;
-        }
-        fastled_set_mem_owner(mRMT_channel, RMT_MEM_OWNER_HW);
+        fillEnd();
+    }
+}
+
+// -- Fill RMT buffer with zeros
+//    A zero item ends the transmission. The next half is flipped to
+//    as in fillNext(): another threshold interrupt can come in before
+//    the RMT reaches the zeros (after a bailout, or a late refill), and
+//    its zeros must go into this channel's memory, not past the end.
+void IRAM_ATTR ESP32RMTController::fillEnd()
+{
+    fastled_set_mem_owner(mRMT_channel, RMT_MEM_OWNER_SW);
+    for (int j = 0; j < mPulsesPerFill; j++) {
+        * mRMT_mem_ptr++ = 0;
+    }
+    fastled_set_mem_owner(mRMT_channel, RMT_MEM_OWNER_HW);
+
+    mWhichHalf++;
+    if (mWhichHalf == 2) {
+        mRMT_mem_ptr = mRMT_mem_start;
+        mWhichHalf = 0;
     }
 }
 
-// -- Init pulse buffer
-//    Set up the buffer that will hold all of the pulse items for this
-//    controller. 
-//    This function is only used when the built-in RMT driver is chosen
-void ESP32RMTController::initPulseBuffer(int size_in_bytes)
+// -- Fill RMT buffer with a reset
+//    Puts mPulsesPerFill low items into the next half of the RMT
+//    memory, long enough in total to make the strip latch. Used in
+//    place of the first fillNext() when a frame is sent again.
+void IRAM_ATTR ESP32RMTController::fillReset()
 {
+    rmt_item32_t low;
+    low.level0 = 0;
+    low.level1 = 0;
+    low.duration0 = (RMT_RESET_DURATION + (2 * mPulsesPerFill) - 1) / (2 * mPulsesPerFill);
+    low.duration1 = low.duration0;
+
+    fastled_set_mem_owner(mRMT_channel, RMT_MEM_OWNER_SW);
+    for (int j = 0; j < mPulsesPerFill; j++) {
+        * mRMT_mem_ptr++ = low.val;
+    }
+    fastled_set_mem_owner(mRMT_channel, RMT_MEM_OWNER_HW);
 
-    mCurPulse = 0;
+    mWhichHalf++;
+    if (mWhichHalf == 2) {
+        mRMT_mem_ptr = mRMT_mem_start;
+        mWhichHalf = 0;
+    }
+}
 
-    // maybe we already have a buffer of the right size, it's likely
-    if (mBuffer && (mBufferSize == size_in_bytes * 8))
-        return;
+// -- Bailout and retry counters
+uint32_t ESP32RMTController::getBailouts() const
+{
+    return mBailouts;
+}
+
+uint32_t ESP32RMTController::getRetries() const
+{
+    return mRetries;
+}
 
-    if (mBuffer) { free(mBuffer); mBuffer = 0; }
+// -- Number of frames skipped because nothing changed
+uint32_t ESP32RMTController::getSkips() const
+{
+    return mSkips;
+}
 
-    // -- Each byte has 8 bits, each bit needs a 32-bit RMT item
-    mBufferSize = size_in_bytes * 8;
+// -- Time on the wire of the last frame
+uint32_t ESP32RMTController::getTransmitTime() const
+{
+    return mTransmitTime;
+}
 
-    mBuffer = (rmt_item32_t *) calloc( mBufferSize, sizeof(rmt_item32_t) );
+// -- Number of registered controllers
+int ESP32RMTController::getNumControllers()
+{
+    return gNumControllers;
+}
 
+// -- Controller by registration order
+ESP32RMTController * ESP32RMTController::getController(int index)
+{
+    if (index < 0 || index >= gNumControllers) return NULL;
+    return gControllers[index];
 }
 
-// -- Convert a byte into RMT pulses
-//    This function is only used when the built-in RMT driver is chosen
-void ESP32RMTController::convertByte(uint32_t byteval)
+// -- Translate pixel data into RMT items
+//    Called by the built-in driver, from its interrupt handler, each
+//    time it needs more items. The driver asks for multiples of 32
+//    items, so we always translate whole 32-bit words of mPixelData.
+void IRAM_ATTR ESP32RMTController::translate(int channel, const void * src, rmt_item32_t * dest, size_t src_size,
+                                             size_t wanted_num, size_t * translated_size, size_t * item_num)
 {
-    // -- Write one byte's worth of RMT pulses to the big buffer
-    byteval <<= 24;
-    for (uint32_t j = 0; j < 8; j++) {
-        mBuffer[mCurPulse] = (byteval & 0x80000000L) ? mOne : mZero;
-        byteval <<= 1;
-        mCurPulse++;
+    ESP32RMTController * pController = gOnChannel[channel];
+    if (pController == NULL || src == NULL || dest == NULL) {
+        *translated_size = 0;
+        *item_num = 0;
+        return;
     }
-}
 
+    size_t words = wanted_num / 32;
+    if (words > src_size / sizeof(uint32_t)) words = src_size / sizeof(uint32_t);
+
+    const uint32_t * pixels = (const uint32_t *) src;
+    uint32_t * pItem = (uint32_t *) dest;
+    for (size_t i = 0; i < words; i++) {
+        uint32_t thispixel = pixels[i];
+        for (int j = 0; j < 8; j++) {
+            const uint32_t * items = pController->mNibbleItems[thispixel >> 28];
+            pItem[0] = items[0];
+            pItem[1] = items[1];
+            pItem[2] = items[2];
+            pItem[3] = items[3];
+            pItem += 4;
+            thispixel <<= 4;
+        }
+    }
+
+    *translated_size = words * sizeof(uint32_t);
+    *item_num = words * 32;
+}
@@ -34,10 +34,74 @@
  * send the data for 8 controllers simultaneously, but 16 controllers
  * would take approximately twice as much time.
  *
+ * When there are more controllers than channels, the queued
+ * controllers are started longest-first (by the size of their pixel
+ * data), each on whichever channel frees up first. This keeps a long
+ * strip registered last from running alone at the end of the frame.
+ * The predicted and measured time to send a whole frame (the
+ * "makespan") can be read with
+ * ESP32RMTController::getPredictedMakespan() and getActualMakespan().
+ * To keep strict registration order instead, add
+ *
+ *     #define FASTLED_RMT_LONGEST_FIRST 0
+ *
+ * By default no strip starts sending until every controller has
+ * converted its pixel data. In pipelined mode each controller is
+ * started as soon as its own data is ready (if a channel is free), so
+ * the conversion of one strip overlaps the transmission of another:
+ *
+ *     #define FASTLED_RMT_PIPELINE 1
+ *
+ * In this mode controllers are started in registration order, since
+ * the later ones are not known yet when the first ones go out.
+ *
+ * Strips that show the same thing frame after frame can be left out
+ * of the schedule, which frees their channel time for the strips that
+ * are animating. Each controller hashes its encoded pixel data as it
+ * loads it; if the hash matches the previous frame, the controller is
+ * skipped. It is still resent every FASTLED_RMT_REFRESH_INTERVAL
+ * frames, and after a frame that was cut short by a timing bailout.
+ * Note that dithering changes the encoded data every frame, so a strip
+ * is only skipped with dithering off (FastLED.setDither(0)) or at full
+ * brightness:
+ *
+ *     #define FASTLED_RMT_SKIP_UNCHANGED 1
+ *
+ * On a dual-core ESP32 the conversion of the pixel data (scaling,
+ * dithering and packing) can be split across both cores. A small
+ * worker task pinned to the other core takes some of the controllers,
+ * chosen so that each core gets about the same number of pixels, and
+ * the frame does not start sending until both cores are done:
+ *
+ *     #define FASTLED_RMT_PARALLEL_ENCODE 1
+ *
+ * This is not combined with pipelined mode, which already overlaps
+ * the conversion with the transmission.
+ *
+ * RMT MEMORY
+ *
+ * The RMT has 8 blocks of memory, 64 items each, shared by all the
+ * channels: a channel that uses k blocks makes the next k-1 channels
+ * unusable. More blocks per channel means more time for the interrupt
+ * handler to refill the buffer, and so fewer glitches from interrupt
+ * latency (wifi, flash), but fewer strips sending at once. Each
+ * controller asks for MEM_BLOCK_NUM blocks by default; a long or
+ * latency-sensitive strip can ask for more, and short strips for
+ * fewer, before the first call to show():
+ *
+ *     ESP32RMTController::getController(0)->setMemBlocks(4);
+ *     ESP32RMTController::getController(1)->setMemBlocks(1);
+ *
+ * When the RMT is initialized, the channels are laid out to fit the
+ * registered controllers, largest request first, for as long as the
+ * memory lasts. Controllers that do not get a channel of their own
+ * are queued as usual, and only start on a channel that has at least
+ * as many blocks as they asked for.
+ *
  * There is a #define that allows a program to control the total
  * number of channels that the driver is allowed to use. It defaults
- * to 8 -- use all the channels. Setting it to 1, for example, results
- * in fully serial output:
+ * to 8 -- as many as the memory layout allows. Setting it to 1, for
+ * example, results in fully serial output:
  *
  *     #define FASTLED_RMT_MAX_CHANNELS 1
  *
@@ -52,12 +116,13 @@
  *
  *      #define FASTLED_RMT_BUILTIN_DRIVER 1
  *
- * There may be a performance penalty for using this mode. We need to
- * compute the RMT signal for the entire LED strip ahead of time,
- * rather than overlapping it with communication. We also need a large
- * buffer to hold the signal specification. Each bit of pixel data is
- * represented by a 32-bit pulse specification, so it is a 32X blow-up
- * in memory use.
+ * In this mode the pixel data is handed to the driver with
+ * rmt_write_sample(), and the driver calls back into a translator to
+ * encode it into RMT items a half-buffer at a time. Memory use is the
+ * same as for the custom driver (4 bytes per 32 bits of pixel data);
+ * there is no longer a separate buffer with one 32-bit item per bit.
+ * The translator runs in the driver's interrupt handler, so there may
+ * still be a small performance penalty.
  *
  * NEW: Use of Flash memory on the ESP32 can interfere with the timing
  *      of pixel output. The ESP-IDF system code disables all other
@@ -81,6 +146,20 @@
  *      send the data while the program continues to prepare the next
  *      frame of data.
  *
+ * NEW: Asynchronous show. FastLED.showAsync() converts the pixel data
+ *      exactly like show(), starts the transmission, and returns
+ *      without waiting for the bits to go out on the wire. Each
+ *      controller then keeps a second (back) buffer for the encoded
+ *      pixel data, so the next frame can be converted while the
+ *      previous one is still being sent. The next call to show() or
+ *      showAsync() waits for the previous frame before starting its
+ *      own transmission. Call FastLED.waitForShow() if you need to
+ *      know that the data has been sent (for example, before
+ *      sleeping or reconfiguring pins). The CRGB array itself is safe
+ *      to modify as soon as showAsync() returns. With
+ *      FASTLED_ESP32_FLASH_LOCK, showAsync() is the same as show(),
+ *      since the flash lock can only be released by waiting.
+ *
  * Based on public domain code created 19 Nov 2016 by Chris Osborn <fozztexx@fozztexx.com>
  * http://insentricity.com *
  *
@@ -107,8 +186,15 @@
 
 #pragma once
 
+#include <new>
+
+#ifdef FASTLED_RMT_EMULATOR
+#include "platforms/host/rmt_emulator.h"
+#endif
+
 FASTLED_NAMESPACE_BEGIN
 
+#ifndef FASTLED_RMT_EMULATOR
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -129,14 +215,20 @@ extern void spi_flash_op_unlock(void);
 #ifdef __cplusplus
 }
 #endif
+#endif
 
 __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
+#ifdef FASTLED_RMT_EMULATOR
+  return rmt_emulator_cycles();
+#else
   uint32_t cyc;
   __asm__ __volatile__ ("rsr %0,ccount":"=a" (cyc));
   return cyc;
+#endif
 }
 
 #define FASTLED_HAS_CLOCKLESS 1
+#define FASTLED_HAS_ASYNC_SHOW 1
 #define NUM_COLOR_CHANNELS 3
 
 
@@ -145,11 +237,13 @@ __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
                                 /* there is no point in higher dividers, as this parameter only needs to make
                                    sure the scaling factors of the RMT intervals fit in 15 bits. */
 
-#define MEM_BLOCK_NUM       2 /* the number of memory blocks. There are 8 for the entire RMT system, and nominally
-                                1 per channel. Using a larger number reduces the number of hardware channels that can be used
-                                at one time, but increases the resistance to RTOS interrupt jitter. 1 seems to be good enough,
-                                but jitter created by wifi might still cause glitches and 2 or more may be reuired. */
-#define PULSES_PER_CHANNEL  (64 * MEM_BLOCK_NUM) /* A channel has a 64 "pulse" buffer of 32 bits (aka Items in RMT interface) */
+#define MEM_BLOCK_NUM       2 /* the default number of memory blocks per controller (see setMemBlocks). There are 8 for the
+                                entire RMT system, and nominally 1 per channel. Using a larger number reduces the number of hardware
+                                channels that can be used at one time, but increases the resistance to RTOS interrupt jitter. 1 seems
+                                to be good enough, but jitter created by wifi might still cause glitches and 2 or more may be reuired. */
+#define RMT_MEM_BLOCKS      8 /* total number of memory blocks */
+#define PULSES_PER_BLOCK    64 /* A block has a 64 "pulse" buffer of 32 bits (aka Items in RMT interface) */
+#define PULSES_PER_CHANNEL  (PULSES_PER_BLOCK * MEM_BLOCK_NUM) /* default size of a channel buffer */
 #define PULSES_PER_FILL     (PULSES_PER_CHANNEL / 2)     /* Half of the channel buffer */
                             // PPF must be a multipel of 32 or fillNext must be re-coded
 
@@ -180,10 +274,56 @@ __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
 #endif
 
 // -- Number of RMT channels to use (up to 8)
-//    Redefine this value to 1 to force serial output
-// -- todo: this is wrong if MEM_BLOCK_NUM is 3, but at least it's safe
+//    Redefine this value to 1 to force serial output. The number
+//    actually used also depends on the memory blocks the controllers
+//    ask for; see init().
 #ifndef FASTLED_RMT_MAX_CHANNELS
-#define FASTLED_RMT_MAX_CHANNELS ( 8 / MEM_BLOCK_NUM )
+#define FASTLED_RMT_MAX_CHANNELS 8
+#endif
+
+// -- Start queued controllers longest-first
+#ifndef FASTLED_RMT_LONGEST_FIRST
+#define FASTLED_RMT_LONGEST_FIRST 1
+#endif
+
+// -- Whole-frame retry on timing bailout
+//    When timingOk() gives up on a channel, the strip shows a partial
+//    frame. Setting this to N > 0 queues the controller again, up to N
+//    times per frame, to resend the whole frame after a reset. Only
+//    used with the custom driver.
+#ifndef FASTLED_RMT_MAX_RETRIES
+#define FASTLED_RMT_MAX_RETRIES 0
+#endif
+
+// -- Skip controllers whose pixel data has not changed since the
+//    last frame, but resend them at least every REFRESH_INTERVAL frames
+#ifndef FASTLED_RMT_SKIP_UNCHANGED
+#define FASTLED_RMT_SKIP_UNCHANGED 0
+#endif
+
+#ifndef FASTLED_RMT_REFRESH_INTERVAL
+#define FASTLED_RMT_REFRESH_INTERVAL 100
+#endif
+
+// -- Pipelined mode: start each controller as soon as its own data
+//    has been converted, instead of after the last one. Controllers
+//    then go out in registration order. Only used with the custom
+//    driver.
+#ifndef FASTLED_RMT_PIPELINE
+#define FASTLED_RMT_PIPELINE 0
+#endif
+#define FASTLED_RMT_PIPELINE_ACTIVE (FASTLED_RMT_PIPELINE && ! FASTLED_RMT_BUILTIN_DRIVER)
+
+// -- Convert the pixel data on both cores
+//    The worker task runs on the core that did not call show(), with
+//    the same priority as the caller
+#ifndef FASTLED_RMT_PARALLEL_ENCODE
+#define FASTLED_RMT_PARALLEL_ENCODE 0
+#endif
+#define FASTLED_RMT_PARALLEL_ENCODE_ACTIVE (FASTLED_RMT_PARALLEL_ENCODE && ! FASTLED_RMT_PIPELINE_ACTIVE && (portNUM_PROCESSORS > 1))
+
+#ifndef FASTLED_RMT_ENCODE_STACK_SIZE
+#define FASTLED_RMT_ENCODE_STACK_SIZE 3072
 #endif
 
 // use this if you want to try the flash lock
@@ -196,13 +336,24 @@ __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
 
 class ESP32RMTController
 {
+public:
+
+    // -- Conversion job for the worker on the other core
+    typedef void (*EncodeFn)(void * arg);
+
 private:
 
     // -- RMT has 8 channels, numbered 0 to 7
-    // NOTE: if you are using MAX_BLOCK not 1, you'll have fewer, 
-    // and you need to "skip around" -- the RMT channels for MAX_BLOCK == 2
-    // are 0, 2, 4, 6.... etc
+    // NOTE: a channel with more than one memory block uses up the
+    // channels after it, so the RMT channel is not the same as our
+    // channel number -- see the layout made in init()
     rmt_channel_t  mRMT_channel;
+    int            mChannel;
+
+    // -- Memory blocks requested for this controller, and the number of
+    //    items per half buffer on the channel it is currently using
+    int            mMemBlocks;
+    int            mPulsesPerFill;
 
     // -- Store the GPIO pin
     gpio_num_t     mPin;
@@ -211,6 +362,14 @@ private:
     rmt_item32_t   mZero;
     rmt_item32_t   mOne;
 
+    // -- RMT items for each 4-bit value, MSB first, built from mZero
+    //    and mOne in the constructor. Lets fillNext() copy four items
+    //    at a time instead of testing every bit.
+    uint32_t       mNibbleItems[16][4];
+
+    // -- Time to send one bit, in CPU cycles (T1 + T2 + T3)
+    uint32_t       mCyclesPerBit;
+
     // -- Total expected time to send 32 bits
     //    Each strip should get an interrupt roughly at this interval
     uint32_t       mCyclesPerFill;
@@ -218,8 +377,18 @@ private:
     uint32_t       mLastFill;
 
     // -- Pixel data
+    //    mPixelData is the buffer being sent; mPixelDataBack is only
+    //    allocated once asynchronous show is used, and receives the
+    //    next frame while mPixelData is still on the wire. Each has
+    //    its own size in words (what was loaded into it) and capacity
+    //    (what was allocated), since a strip can change length or
+    //    bytes per led (setRgbw()) between frames.
     uint32_t *     mPixelData;
+    uint32_t *     mPixelDataBack;
     int            mSize;
+    int            mSizeBack;
+    int            mCapacity;
+    int            mCapacityBack;
     int            mCur;
 
     // -- RMT memory
@@ -227,11 +396,28 @@ private:
     volatile uint32_t * mRMT_mem_start;
     int                 mWhichHalf;
 
-    // -- Buffer to hold all of the pulses. For the version that uses
-    //    the RMT driver built into the ESP core.
-    rmt_item32_t * mBuffer;
-    uint16_t       mBufferSize;
-    int            mCurPulse;
+    // -- Timing bailouts
+    //    mBailedOut is set by timingOk() for the frame being sent;
+    //    mRetryPending marks that the next start is a resend
+    bool           mBailedOut;
+    bool           mRetryPending;
+    int            mFrameRetries;
+    uint32_t       mBailouts;
+    uint32_t       mRetries;
+
+    // -- Unchanged frame detection
+    //    mFrameHash is the hash of the last frame loaded; mSkip is set
+    //    when the current frame matches it and can be left out
+    uint32_t       mFrameHash;
+    bool           mHashValid;
+    bool           mSkip;
+    int            mFramesSkipped;
+    uint32_t       mSkips;
+
+    // -- Time on the wire: when the frame first started (esp_timer
+    //    us) and how long the last one took, retries included
+    int64_t        mTransmitStart;
+    uint32_t       mTransmitTime;
 
 public:
 
@@ -243,17 +429,101 @@ public:
     // -- Get max cycles per fill
     uint32_t IRAM_ATTR getMaxCyclesPerFill() const { return mMaxCyclesPerFill; }
 
+    // -- What this controller sends: its pin, the frame on the wire
+    //    (mSize words, MSB first), and the RMT items for a 1 and a 0
+    int getPin() const { return mPin; }
+    const uint32_t * getPixelData() const { return mPixelData; }
+    int getSize() const { return mSize; }
+    uint32_t getOneItem() const { return mOne.val; }
+    uint32_t getZeroItem() const { return mZero.val; }
+
     // -- Get or create the pixel data buffer
+    //    Returns the buffer that the next frame should be loaded into
     uint32_t * getPixelBuffer(int size_in_bytes);
 
+    // -- Record the hash of the frame just loaded
+    //    Decides whether this controller can skip the frame
+    void setFrameHash(uint32_t hash);
+
+    // -- Decide where this controller's data is converted
+    //    Returns true if it should go to the worker on the other core,
+    //    which is the case when that core has less work so far this frame
+    bool claimOtherCore(int size_in_bytes);
+
+    // -- Hand a conversion job to the worker on the other core
+    static void encodeOnOtherCore(EncodeFn fn, void * arg);
+
+    // -- Wait for the worker to finish the jobs handed to it this frame
+    static void waitForEncode();
+
+    // -- Select asynchronous show
+    //    When set, the last call to showPixels() starts the
+    //    transmission and returns without waiting for it to finish
+    static void setAsync(bool async);
+    static bool isAsync();
+
+    // -- Wait for the current transmission (if any) to finish
+    static void waitForShow();
+
+    // -- Memory blocks for this controller (1 to 8)
+    //    Changing it makes the next show() lay out the channels again;
+    //    checked and clamped in init()
+    void setMemBlocks(int blocks);
+    int getMemBlocks() const;
+
     // -- Initialize RMT subsystem
-    //    This only needs to be done once
+    //    Lays out the channels to fit the memory blocks asked for by the
+    //    registered controllers. Does nothing unless a controller was
+    //    added or changed its memory blocks since the last layout.
     static void init();
 
+    // -- Number of channels in use, and the RMT channel and memory
+    //    blocks of each, as laid out by init()
+    static int getNumChannels();
+    static int getChannelBlocks(int channel);
+
+    // -- Take the first queued controller that fits on this channel
+    //    Must be called with gRMT_mux held
+    static ESP32RMTController * IRAM_ATTR claimNext(int channel);
+
     // -- Show this string of pixels
     //    This is the main entry point for the pixel controller
     void IRAM_ATTR showPixels();
 
+    // -- Swap the front and back pixel buffers
+    //    Only called once the previous frame has been sent
+    void swapPixelBuffers();
+
+    // -- Number of bits this controller sends per frame
+    int numBits() const;
+
+    // -- Order the controllers for this frame
+    //    Fills the start queue (longest first, unless disabled) and
+    //    computes the predicted makespan for that order.
+    static void buildSchedule();
+
+    // -- Predict the makespan of the queued controllers
+    static void predictMakespan();
+
+    // -- Begin a frame
+    //    Waits for the previous frame and resets the counters
+    static void beginFrame();
+
+    // -- End of frame: every controller is done or skipped
+    //    Marks the time and gives back the semaphore
+    static void IRAM_ATTR endFrame(bool from_isr);
+
+    // -- Add this controller to the start queue (pipelined mode)
+    //    and start it at once if a channel is free
+    void enqueue();
+
+    // -- Predicted time to send the last frame on all channels, in microseconds
+    static uint32_t getPredictedMakespan();
+
+    // -- Measured time from the first channel starting to the last
+    //    one finishing for the last completed frame, in microseconds
+    static uint32_t getActualMakespan();
+
     // -- Start up the next controller
     //    This method is static so that it can dispatch to the
     //    appropriate startOnChannel method of the given controller.
@@ -306,15 +576,39 @@ public:
     //    long to hold the signal high, followed by how long to hold it low.
     void IRAM_ATTR fillNext();
 
-    // -- Init pulse buffer
-    //    Set up the buffer that will hold all of the pulse items for this
-    //    controller. 
-    //    This function is only used when the built-in RMT driver is chosen
-    void initPulseBuffer(int size_in_bytes);
+    // -- Build the nibble lookup table
+    //    Precomputes the four RMT items for every 4-bit value
+    void initNibbleItems();
+
+    // -- Fill RMT buffer with a reset
+    //    Holds the line low for the reset time; used instead of the
+    //    first fillNext() when a bailed-out frame is sent again
+    void IRAM_ATTR fillReset();
+
+    // -- Fill RMT buffer with zeros, which end the transmission
+    void IRAM_ATTR fillEnd();
 
-    // -- Convert a byte into RMT pulses
-    //    This function is only used when the built-in RMT driver is chosen
-    void convertByte(uint32_t byteval);
+    // -- Number of timing bailouts and whole-frame retries so far
+    uint32_t getBailouts() const;
+    uint32_t getRetries() const;
+
+    // -- Number of frames skipped because nothing changed
+    uint32_t getSkips() const;
+
+    // -- How long the last frame was on the wire, in microseconds,
+    //    from its first start until it was done, retries included
+    uint32_t getTransmitTime() const;
+
+    // -- Registered controllers, in the order they were added
+    //    (the same order as FastLED[i])
+    static int getNumControllers();
+    static ESP32RMTController * getController(int index);
+
+    // -- Translate pixel data into RMT items
+    //    Used as the sample-to-item callback of the built-in RMT driver
+    //    for whichever controller is on the given channel
+    static void IRAM_ATTR translate(int channel, const void * src, rmt_item32_t * dest, size_t src_size,
+                                    size_t wanted_num, size_t * translated_size, size_t * item_num);
 };
 
 template <int DATA_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = RGB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 5>
@@ -328,6 +622,17 @@ private:
     // -- This instantiation forces a check on the pin choice
     FastPin<DATA_PIN> mFastPin;
 
+    // -- Copy of the pixel controller, for a conversion on the other
+    //    core. Only valid from showPixels() until the frame is sent.
+    alignas(PixelController<RGB_ORDER>) uint8_t mPixelsCopy[sizeof(PixelController<RGB_ORDER>)];
+
+    // -- Conversion job run by the worker on the other core
+    static void encodeJob(void * arg)
+    {
+        ClocklessController * self = (ClocklessController *) arg;
+        self->loadPixelData(* (PixelController<RGB_ORDER> *) self->mPixelsCopy);
+    }
+
 public:
 
     ClocklessController()
@@ -348,47 +653,62 @@ protected:
     //    by the RMT driver. Copying does two important jobs: it fixes the color
     //    order for the pixels, and it performs the scaling/adjusting ahead of time.
     //    It also packs the bytes into 32 bit chunks with the right bit order.
+    //    For RGBW leds it also takes out the white, and sends four bytes per led.
     void loadPixelData(PixelController<RGB_ORDER> & pixels)
     {
+        const bool rgbw = this->isRgbw();
+        const CRGBWhite & white = this->getWhite();
+        const int bytes_per_led = rgbw ? 4 : 3;
+
         // -- Make sure the buffer is allocated
-        int size_in_bytes = pixels.size() * 3;
+        int size_in_bytes = pixels.size() * bytes_per_led;
         uint32_t * pData = mRMTController.getPixelBuffer(size_in_bytes);
 
+        // -- FNV-1a hash of the packed words, for unchanged frame detection
+        uint32_t hash = 2166136261UL;
+
         // -- Read out the pixel data using the pixel controller methods that
-        //    perform the scaling and adjustments 
+        //    perform the scaling and adjustments, and pack the bytes into
+        //    32-bit values with the right bit order
         int count = 0;
-        int which = 0;
+        uint32_t word = 0;
+        int bytes = 0;
         while (pixels.has(1)) {
-            // -- Get the next four bytes of data
-            uint8_t four[4] = {0,0,0,0};
-            for (int i = 0; i < 4; i++) {
-                switch (which) {
-                case 0: 
-                    four[i] = pixels.loadAndScale0();
-                    break;
-                case 1:
-                    four[i] = pixels.loadAndScale1();
-                    break;
-                case 2:
-                    four[i] = pixels.loadAndScale2();
-                    pixels.advanceData();
-                    pixels.stepDithering();
-                    break;
+            uint8_t led[4];
+            if (rgbw) {
+                led[3] = pixels.loadAndScaleRGBW(white, led[0], led[1], led[2]);
+            } else {
+                led[0] = pixels.loadAndScale0();
+                led[1] = pixels.loadAndScale1();
+                led[2] = pixels.loadAndScale2();
+            }
+            pixels.advanceData();
+            pixels.stepDithering();
+
+            for (int i = 0; i < bytes_per_led; i++) {
+                word = (word << 8) | led[i];
+                if (++bytes == 4) {
+                    pData[count++] = word;
+                    if (FASTLED_RMT_SKIP_UNCHANGED) {
+                        hash = (hash ^ word) * 16777619UL;
+                    }
+                    word = 0;
+                    bytes = 0;
                 }
-                // -- Move to the next color
-                which++;
-                if (which > 2) which = 0;
+            }
+        }
 
-                // -- Stop if there's no more data
-                if ( ! pixels.has(1)) break;
+        // -- Last partial word, padded with zeros
+        if (bytes) {
+            word <<= 8 * (4 - bytes);
+            pData[count++] = word;
+            if (FASTLED_RMT_SKIP_UNCHANGED) {
+                hash = (hash ^ word) * 16777619UL;
             }
+        }
 
-            // -- Pack the four bytes into a 32-bit value with the right bit order
-            uint8_t a = four[0];
-            uint8_t b = four[1];
-            uint8_t c = four[2];
-            uint8_t d = four[3];
-            pData[count++] = a << 24 | b << 16 | c << 8 | d;
+        if (FASTLED_RMT_SKIP_UNCHANGED) {
+            mRMTController.setFrameHash(hash);
         }
     }
 
@@ -396,40 +716,17 @@ protected:
     //    This is the main entry point for the controller.
     virtual void showPixels(PixelController<RGB_ORDER> & pixels)
     {
-        if (FASTLED_RMT_BUILTIN_DRIVER) {
-            convertAllPixelData(pixels);
+        if (FASTLED_RMT_PARALLEL_ENCODE_ACTIVE && mRMTController.claimOtherCore(pixels.size() * (this->isRgbw() ? 4 : 3))) {
+            // -- The pixel controller only lives until we return, so the
+            //    worker gets its own copy
+            new (mPixelsCopy) PixelController<RGB_ORDER>(pixels);
+            ESP32RMTController::encodeOnOtherCore(encodeJob, this);
         } else {
             loadPixelData(pixels);
         }
 
         mRMTController.showPixels();
     }
-
-    // -- Convert all pixels to RMT pulses
-    //    This function is only used when the user chooses to use the
-    //    built-in RMT driver, which needs all of the RMT pulses
-    //    up-front. TODO: this has a large memory allocation which
-    //    could fail, should return an error if so
-    void convertAllPixelData(PixelController<RGB_ORDER> & pixels)
-    {
-        // -- Make sure the data buffer is allocated
-        mRMTController.initPulseBuffer(pixels.size() * 3);
-
-        // -- Cycle through the R,G, and B values in the right order,
-        //    storing the pulses in the big buffer
-
-        uint32_t byteval;
-        while (pixels.has(1)) {
-            byteval = pixels.loadAndScale0();
-            mRMTController.convertByte(byteval);
-            byteval = pixels.loadAndScale1();
-            mRMTController.convertByte(byteval);
-            byteval = pixels.loadAndScale2();
-            mRMTController.convertByte(byteval);
-            pixels.advanceData();
-            pixels.stepDithering();
-        }
-    }
 };
 
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "fastpin_esp32.h"
+#include "trace_esp32.h"
 
 #ifdef FASTLED_ALL_PINS_HARDWARE_SPI
 #include "fastspi_esp32.h"
@@ -0,0 +1,99 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+#if FASTLED_ESP32_TRACE == 1
+
+FASTLED_NAMESPACE_BEGIN
+
+// -- The ring itself
+//    Kept in DRAM so that it can be written from IRAM interrupt
+//    handlers while the flash cache is disabled
+DRAM_ATTR fastled_trace_event_t gFastLEDTrace[FASTLED_ESP32_TRACE_SIZE];
+DRAM_ATTR volatile uint32_t gFastLEDTraceHead = 0;
+
+// -- Next event to hand out; only touched by the draining task
+static uint32_t gTraceTail = 0;
+
+#define TRACE_HISTOGRAM_CHANNELS 8
+#define TRACE_HISTOGRAM_BUCKETS  16
+
+// -- Copy out the events recorded since the last drain, oldest first
+int fastled_trace_drain(fastled_trace_event_t * events, int max_events, uint32_t * lost)
+{
+    uint32_t head = gFastLEDTraceHead;
+
+    // -- If the writers have lapped us, skip to the oldest event
+    //    still in the ring
+    uint32_t dropped = 0;
+    if (head - gTraceTail > FASTLED_ESP32_TRACE_SIZE) {
+        dropped = head - gTraceTail - FASTLED_ESP32_TRACE_SIZE;
+        gTraceTail = head - FASTLED_ESP32_TRACE_SIZE;
+    }
+    if (lost) *lost = dropped;
+
+    int n = 0;
+    while ((gTraceTail != head) && (n < max_events)) {
+        events[n++] = gFastLEDTrace[gTraceTail & (FASTLED_ESP32_TRACE_SIZE - 1)];
+        gTraceTail++;
+    }
+    return n;
+}
+
+// -- Drain the ring and print a refill latency histogram per channel
+void fastled_trace_print_histogram(int bucket_us)
+{
+    uint32_t histogram[TRACE_HISTOGRAM_CHANNELS][TRACE_HISTOGRAM_BUCKETS];
+    uint32_t max_us[TRACE_HISTOGRAM_CHANNELS];
+    uint32_t bailouts[TRACE_HISTOGRAM_CHANNELS];
+    memset(histogram, 0, sizeof(histogram));
+    memset(max_us, 0, sizeof(max_us));
+    memset(bailouts, 0, sizeof(bailouts));
+
+    if (bucket_us < 1) bucket_us = 1;
+
+    fastled_trace_event_t events[64];
+    uint32_t lost_total = 0;
+    uint32_t lost;
+    int n;
+    while ((n = fastled_trace_drain(events, 64, &lost)) > 0) {
+        lost_total += lost;
+        for (int i = 0; i < n; i++) {
+            uint32_t info = events[i].info;
+            uint32_t channel = FASTLED_TRACE_CHANNEL(info);
+            if (channel >= TRACE_HISTOGRAM_CHANNELS) continue;
+
+            switch (FASTLED_TRACE_TYPE(info)) {
+            case FASTLED_TRACE_REFILL_START: {
+                uint32_t us = FASTLED_TRACE_VALUE(info) / (F_CPU / 1000000L);
+                uint32_t bucket = us / bucket_us;
+                if (bucket >= TRACE_HISTOGRAM_BUCKETS) bucket = TRACE_HISTOGRAM_BUCKETS - 1;
+                histogram[channel][bucket]++;
+                if (us > max_us[channel]) max_us[channel] = us;
+                break;
+            }
+            case FASTLED_TRACE_BAILOUT:
+                bailouts[channel]++;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    printf("fastled trace: refill latency, %d us buckets, %u events lost\n", bucket_us, lost_total);
+    for (int channel = 0; channel < TRACE_HISTOGRAM_CHANNELS; channel++) {
+        uint32_t total = 0;
+        for (int b = 0; b < TRACE_HISTOGRAM_BUCKETS; b++) total += histogram[channel][b];
+        if (total == 0 && bailouts[channel] == 0) continue;
+
+        printf(" ch %d: max %u us, %u bailouts |", channel, max_us[channel], bailouts[channel]);
+        for (int b = 0; b < TRACE_HISTOGRAM_BUCKETS; b++) {
+            printf(" %u", histogram[channel][b]);
+        }
+        printf("\n");
+    }
+}
+
+FASTLED_NAMESPACE_END
+
+#endif /* FASTLED_ESP32_TRACE == 1 */
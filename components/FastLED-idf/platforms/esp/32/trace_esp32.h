@@ -0,0 +1,113 @@
+/*
+ * Interrupt event trace for the ESP32 clockless drivers
+ *
+ * The FASTLED_ESP32_SHOWTIMING output formats text from inside the
+ * interrupt handler, which disturbs the very timing it is trying to
+ * measure. This trace instead records fixed-size binary events into
+ * a ring buffer in DRAM: each event is a CPU cycle count and one
+ * packed word, written with plain 32-bit stores. Nothing is formatted
+ * until a task drains the ring.
+ *
+ * To enable it, set the following (the default is off, and the trace
+ * calls compile to nothing):
+ *
+ *     #define FASTLED_ESP32_TRACE 1
+ *
+ * Events recorded:
+ *
+ *   REFILL_START   the interrupt handler is about to refill a channel;
+ *                  value is the number of CPU cycles since the previous
+ *                  fill of that channel
+ *   REFILL_END     the refill is done; value is the cycles it took
+ *   CHANNEL_START  a controller was started on a channel; value is
+ *                  the size of its pixel data in 32-bit words (RMT) or
+ *                  0 (I2S)
+ *   CHANNEL_DONE   a channel finished sending
+ *   BAILOUT        timingOk() gave up on a channel; value is the
+ *                  position (mCur) it had reached
+ *
+ * The ring holds FASTLED_ESP32_TRACE_SIZE events. When it is full the
+ * oldest events are overwritten; fastled_trace_drain() reports how
+ * many were lost. Cycle counts come from the CCOUNT register of the
+ * core that recorded the event.
+ *
+ * From a task, either copy the events out with fastled_trace_drain()
+ * or call fastled_trace_print_histogram() to drain the ring and print
+ * a per-channel histogram of refill latency. This is the number to
+ * watch when choosing the memory blocks for a controller (see
+ * ESP32RMTController::setMemBlocks()): a channel glitches when the
+ * latency exceeds the time it takes to send half its buffer.
+ */
+
+#pragma once
+
+#ifndef FASTLED_ESP32_TRACE
+#define FASTLED_ESP32_TRACE 0
+#endif
+
+// -- Number of events in the ring, must be a power of two
+#ifndef FASTLED_ESP32_TRACE_SIZE
+#define FASTLED_ESP32_TRACE_SIZE 1024
+#endif
+
+FASTLED_NAMESPACE_BEGIN
+
+enum EFastLEDTraceEvent {
+    FASTLED_TRACE_REFILL_START  = 1,
+    FASTLED_TRACE_REFILL_END    = 2,
+    FASTLED_TRACE_CHANNEL_START = 3,
+    FASTLED_TRACE_CHANNEL_DONE  = 4,
+    FASTLED_TRACE_BAILOUT       = 5
+};
+
+// -- One trace event
+//    info packs the event type (top 4 bits), the channel (next 4 bits)
+//    and a 24-bit value, saturated
+typedef struct {
+    uint32_t cycles;
+    uint32_t info;
+} fastled_trace_event_t;
+
+#define FASTLED_TRACE_TYPE(info)     ((info) >> 28)
+#define FASTLED_TRACE_CHANNEL(info)  (((info) >> 24) & 0xF)
+#define FASTLED_TRACE_VALUE(info)    ((info) & 0xFFFFFF)
+
+#if FASTLED_ESP32_TRACE == 1
+
+extern fastled_trace_event_t gFastLEDTrace[FASTLED_ESP32_TRACE_SIZE];
+extern volatile uint32_t gFastLEDTraceHead;
+
+// -- Record an event
+//    Callable from interrupt handlers on either core: the slot is
+//    claimed with an atomic increment, then filled with two stores.
+__attribute__ ((always_inline)) inline static void fastled_trace(uint32_t type, uint32_t channel, uint32_t value)
+{
+    uint32_t cyc;
+    __asm__ __volatile__ ("rsr %0,ccount":"=a" (cyc));
+
+    if (value > 0xFFFFFF) value = 0xFFFFFF;
+    uint32_t slot = __atomic_fetch_add(&gFastLEDTraceHead, 1, __ATOMIC_RELAXED) & (FASTLED_ESP32_TRACE_SIZE - 1);
+    gFastLEDTrace[slot].cycles = cyc;
+    gFastLEDTrace[slot].info = (type << 28) | ((channel & 0xF) << 24) | value;
+}
+
+// -- Copy out the events recorded since the last drain, oldest first
+//    Returns the number of events copied (at most max_events). If
+//    lost is not NULL, it receives the number of events that were
+//    overwritten before they could be drained.
+int fastled_trace_drain(fastled_trace_event_t * events, int max_events, uint32_t * lost);
+
+// -- Drain the ring and print a refill latency histogram per channel
+//    Buckets are bucket_us microseconds wide; the last one collects
+//    everything beyond. Also prints the number of bailouts.
+void fastled_trace_print_histogram(int bucket_us = 10);
+
+#define FASTLED_TRACE(type, channel, value) fastled_trace((type), (channel), (value))
+
+#else
+
+#define FASTLED_TRACE(type, channel, value) do { } while (0)
+
+#endif /* FASTLED_ESP32_TRACE == 1 */
+
+FASTLED_NAMESPACE_END
@@ -0,0 +1,154 @@
+/*
+ * Virtual clockless controller for the host build
+ *
+ * Stands in for the RMT and I2S drivers when the library is built on
+ * Linux. Each show() runs the same color processing as on the device
+ * (scaling, dithering, color order) and records the resulting bytes,
+ * in the order they would go out on the wire, in a buffer per strip.
+ *
+ * Nothing is actually sent, but the waveform is fully determined by
+ * the recorded bits and the T1/T2/T3 timings of the chipset, so the
+ * controller can answer, to the CPU cycle, how long each pulse and
+ * each frame would take. Timings are in cycles of F_CPU, which the
+ * host build sets to the ESP32 clock.
+ *
+ * Recorded frames can be read back through HostClocklessController,
+ * in the order the controllers were added:
+ *
+ *     HostClocklessController * strip = HostClocklessController::getController(0);
+ *     const uint8_t * bytes = strip->getData();
+ *     int n = strip->getSize();
+ *     uint32_t cycles = strip->getFrameCycles();
+ */
+
+#pragma once
+
+FASTLED_NAMESPACE_BEGIN
+
+#define FASTLED_HAS_CLOCKLESS 1
+
+// -- Max number of controllers we keep track of
+#ifndef FASTLED_HOST_MAX_CONTROLLERS
+#define FASTLED_HOST_MAX_CONTROLLERS 32
+#endif
+
+// -- Time the line is held low after a frame, for the strip to latch
+#define HOST_RESET_US 50
+
+class HostClocklessController
+{
+private:
+
+    int            mPin;
+
+    // -- Pulse widths for a one and a zero bit, in CPU cycles
+    uint32_t       mOneHigh;
+    uint32_t       mOneLow;
+    uint32_t       mZeroHigh;
+    uint32_t       mZeroLow;
+
+    // -- The last frame, in wire order
+    uint8_t *      mData;
+    int            mSize;
+    int            mCapacity;
+
+    // -- Frame counters
+    uint32_t       mFrames;
+    uint32_t       mFrameCycles;
+    uint64_t       mTotalCycles;
+
+public:
+
+    // -- Constructor
+    //    Stores the timing of the chipset and registers the controller
+    HostClocklessController(int DATA_PIN, int T1, int T2, int T3);
+
+    // -- Get the buffer for the next frame
+    uint8_t * getPixelBuffer(int size_in_bytes);
+
+    // -- Record the frame just loaded
+    void showPixels();
+
+    // -- The last frame
+    int getPin() const { return mPin; }
+    const uint8_t * getData() const { return mData; }
+    int getSize() const { return mSize; }
+
+    // -- Bit i of the last frame, in the order it goes out (MSB first)
+    bool getBit(int i) const;
+
+    // -- Length of the high and low parts of bit i, in CPU cycles
+    void getPulse(int i, uint32_t * high, uint32_t * low) const;
+
+    // -- Number of frames shown so far
+    uint32_t getNumFrames() const { return mFrames; }
+
+    // -- Time to send the last frame, including the reset, in CPU cycles
+    uint32_t getFrameCycles() const { return mFrameCycles; }
+
+    // -- Time to send all the frames so far, in CPU cycles
+    uint64_t getTotalCycles() const { return mTotalCycles; }
+
+    // -- Registered controllers, in the order they were added
+    //    (the same order as FastLED[i])
+    static int getNumControllers();
+    static HostClocklessController * getController(int index);
+};
+
+template <int DATA_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = RGB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 5>
+class ClocklessController : public CPixelLEDController<RGB_ORDER>
+{
+private:
+
+    // -- The recorder for this strip
+    HostClocklessController mHostController;
+
+    // -- This instantiation forces a check on the pin choice
+    FastPin<DATA_PIN> mFastPin;
+
+public:
+
+    ClocklessController()
+        : mHostController(DATA_PIN, T1, T2, T3)
+        {}
+
+    void init() { }
+
+    virtual uint16_t getMaxRefreshRate() const { return 400; }
+
+protected:
+
+    // -- Load pixel data
+    //    Scales, dithers and reorders the pixels exactly like the
+    //    device drivers do, one byte per color channel (and one for
+    //    white, for RGBW leds)
+    void loadPixelData(PixelController<RGB_ORDER> & pixels)
+    {
+        const bool rgbw = this->isRgbw();
+        uint8_t * pData = mHostController.getPixelBuffer(pixels.size() * (rgbw ? 4 : 3));
+
+        while (pixels.has(1)) {
+            if (rgbw) {
+                pData[3] = pixels.loadAndScaleRGBW(this->getWhite(), pData[0], pData[1], pData[2]);
+                pData += 4;
+            } else {
+                *pData++ = pixels.loadAndScale0();
+                *pData++ = pixels.loadAndScale1();
+                *pData++ = pixels.loadAndScale2();
+            }
+            pixels.advanceData();
+            pixels.stepDithering();
+        }
+    }
+
+    // -- Show pixels
+    //    This is the main entry point for the controller.
+    virtual void showPixels(PixelController<RGB_ORDER> & pixels)
+    {
+        loadPixelData(pixels);
+
+        mHostController.showPixels();
+    }
+};
+
+FASTLED_NAMESPACE_END
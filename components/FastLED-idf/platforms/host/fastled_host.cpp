@@ -0,0 +1,151 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+#ifdef FASTLED_HOST
+
+#include <time.h>
+#include <sched.h>
+
+FASTLED_NAMESPACE_BEGIN
+
+// -- Virtual GPIO output registers
+volatile uint32_t gHostGPIO[2] = {0, 0};
+
+#if !defined(FASTLED_RMT_EMULATOR) && !defined(FASTLED_I2S_EMULATOR)
+
+// -- Array of all controllers, in the order they were added
+static HostClocklessController * gControllers[FASTLED_HOST_MAX_CONTROLLERS];
+static int gNumControllers = 0;
+
+HostClocklessController::HostClocklessController(int DATA_PIN, int T1, int T2, int T3)
+    : mPin(DATA_PIN),
+      mData(0),
+      mSize(0),
+      mCapacity(0),
+      mFrames(0),
+      mFrameCycles(0),
+      mTotalCycles(0)
+{
+    // -- The same pulses as the RMT driver: a one is high for T1+T2
+    //    and low for T3, a zero is high for T1 and low for T2+T3
+    mOneHigh = T1 + T2;
+    mOneLow = T3;
+    mZeroHigh = T1;
+    mZeroLow = T2 + T3;
+
+    if (gNumControllers < FASTLED_HOST_MAX_CONTROLLERS) {
+        gControllers[gNumControllers] = this;
+        gNumControllers++;
+    }
+}
+
+// -- Get the buffer for the next frame
+//    Grows if the strip got longer since the last frame
+uint8_t * HostClocklessController::getPixelBuffer(int size_in_bytes)
+{
+    if (size_in_bytes > mCapacity) {
+        mData = (uint8_t *) realloc(mData, size_in_bytes);
+        mCapacity = size_in_bytes;
+    }
+    mSize = size_in_bytes;
+    return mData;
+}
+
+// -- Record the frame just loaded
+//    Adds up the pulse widths of every bit, plus the reset
+void HostClocklessController::showPixels()
+{
+    uint32_t ones = 0;
+    for (int i = 0; i < mSize; i++) {
+        ones += __builtin_popcount(mData[i]);
+    }
+    uint32_t zeros = (mSize * 8) - ones;
+
+    mFrameCycles = ones * (mOneHigh + mOneLow) + zeros * (mZeroHigh + mZeroLow)
+                 + HOST_RESET_US * (F_CPU / 1000000L);
+    mTotalCycles += mFrameCycles;
+    mFrames++;
+}
+
+// -- Bit i of the last frame, MSB of each byte first
+bool HostClocklessController::getBit(int i) const
+{
+    if (i < 0 || i >= mSize * 8) return false;
+    return (mData[i / 8] >> (7 - (i % 8))) & 1;
+}
+
+// -- Length of the high and low parts of bit i
+void HostClocklessController::getPulse(int i, uint32_t * high, uint32_t * low) const
+{
+    if (getBit(i)) {
+        *high = mOneHigh;
+        *low = mOneLow;
+    } else {
+        *high = mZeroHigh;
+        *low = mZeroLow;
+    }
+}
+
+// -- Number of registered controllers
+int HostClocklessController::getNumControllers()
+{
+    return gNumControllers;
+}
+
+// -- Controller by registration order
+HostClocklessController * HostClocklessController::getController(int index)
+{
+    if (index < 0 || index >= gNumControllers) return NULL;
+    return gControllers[index];
+}
+
+#endif /* ! FASTLED_RMT_EMULATOR && ! FASTLED_I2S_EMULATOR */
+
+FASTLED_NAMESPACE_END
+
+// -- Time functions, from the monotonic clock
+//    Counted from the first call, like the ESP32 timers count from boot
+
+static uint64_t host_now_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static uint64_t host_start_us()
+{
+    static uint64_t start = host_now_us();
+    return start;
+}
+
+unsigned long micros(void)
+{
+    return (unsigned long) (host_now_us() - host_start_us());
+}
+
+unsigned long millis(void)
+{
+    return (unsigned long) ((host_now_us() - host_start_us()) / 1000);
+}
+
+void delay(uint32_t ms)
+{
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    uint64_t start = host_now_us();
+    while ((host_now_us() - start) < us);
+}
+
+void yield(void)
+{
+    sched_yield();
+}
+
+#endif /* FASTLED_HOST */
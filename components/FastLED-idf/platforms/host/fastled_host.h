@@ -0,0 +1,17 @@
+#pragma once
+
+#include "fastpin_host.h"
+
+#if defined(FASTLED_RMT_EMULATOR)
+// -- The real RMT driver, on the emulated peripheral
+#include "rmt_emulator.h"
+#include "platforms/esp/32/trace_esp32.h"
+#include "platforms/esp/32/clockless_rmt_esp32.h"
+#elif defined(FASTLED_I2S_EMULATOR)
+// -- The real I2S driver, on the emulated peripheral
+#include "i2s_emulator.h"
+#include "platforms/esp/32/trace_esp32.h"
+#include "platforms/esp/32/clockless_i2s_esp32.h"
+#else
+#include "clockless_host.h"
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+
+FASTLED_NAMESPACE_BEGIN
+
+// -- Virtual GPIO output registers, laid out like the ESP32 ones:
+//    pins 0-31 in the first word, 32-39 in the second
+extern volatile uint32_t gHostGPIO[2];
+
+template<uint8_t PIN, uint32_t MASK> class _HOSTPIN {
+
+public:
+  typedef volatile uint32_t * port_ptr_t;
+  typedef uint32_t port_t;
+
+  inline static void setOutput() { }
+  inline static void setInput() { }
+
+  inline static void hi() __attribute__ ((always_inline)) { *port() |= MASK; }
+  inline static void lo() __attribute__ ((always_inline)) { *port() &= ~MASK; }
+  inline static void set(register port_t val) __attribute__ ((always_inline)) { *port() = val; }
+
+  inline static void strobe() __attribute__ ((always_inline)) { toggle(); toggle(); }
+
+  inline static void toggle() __attribute__ ((always_inline)) { *port() ^= MASK; }
+
+  inline static void hi(register port_ptr_t port) __attribute__ ((always_inline)) { hi(); }
+  inline static void lo(register port_ptr_t port) __attribute__ ((always_inline)) { lo(); }
+  inline static void fastset(register port_ptr_t port, register port_t val) __attribute__ ((always_inline)) { *port = val; }
+
+  inline static port_t hival() __attribute__ ((always_inline)) { return *port() | MASK; }
+  inline static port_t loval() __attribute__ ((always_inline)) { return *port() & ~MASK; }
+
+  inline static port_ptr_t port() __attribute__ ((always_inline)) { return &gHostGPIO[PIN < 32 ? 0 : 1]; }
+
+  inline static port_t mask() __attribute__ ((always_inline)) { return MASK; }
+
+  inline static bool isset() __attribute__ ((always_inline)) { return *port() & MASK; }
+};
+
+#define _FL_DEFPIN(PIN)  template<> class FastPin<PIN> : public _HOSTPIN<PIN, ((PIN<32)?((uint32_t)1 << PIN):((uint32_t)1 << (PIN-32)))> {};
+
+// -- The same pins as the ESP32, so that a sketch with a pin that
+//    would not work on the device does not build here either
+_FL_DEFPIN(0);
+_FL_DEFPIN(1);
+_FL_DEFPIN(2);
+_FL_DEFPIN(3);
+_FL_DEFPIN(4);
+_FL_DEFPIN(5);
+
+_FL_DEFPIN(12);
+_FL_DEFPIN(13);
+_FL_DEFPIN(14);
+_FL_DEFPIN(15);
+_FL_DEFPIN(16);
+_FL_DEFPIN(17);
+_FL_DEFPIN(18);
+_FL_DEFPIN(19);
+
+_FL_DEFPIN(21);
+_FL_DEFPIN(22);
+_FL_DEFPIN(23);
+
+_FL_DEFPIN(25);
+_FL_DEFPIN(26);
+_FL_DEFPIN(27);
+
+_FL_DEFPIN(32);
+_FL_DEFPIN(33);
+
+#define HAS_HARDWARE_PIN_SUPPORT
+
+FASTLED_NAMESPACE_END
@@ -0,0 +1,293 @@
+/*
+ * Software model of the ESP32 I2S peripheral, for the host build
+ * (see i2s_emulator.h)
+ */
+
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+#ifdef FASTLED_I2S_EMULATOR
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+struct i2s_emulator_sem {
+    UBaseType_t count;
+};
+
+i2s_dev_t I2S0;
+i2s_dev_t I2S1;
+
+const uint32_t GPIO_PIN_MUX_REG[40] = { 0 };
+
+// -- Interrupt handler, as registered by the driver
+static intr_handler_t gHandler = NULL;
+static void * gHandlerArg = NULL;
+static bool gIntrEnabled = false;
+
+// -- Interrupt timing
+static int gMaxLate = 1;
+static bool gDuplicates = false;
+static uint32_t gRandom = 12345;
+static uint32_t gNumInterrupts = 0;
+
+// -- The DMA: the descriptor it sends next, and buffers sent since
+//    the last interrupt was handled
+static lldesc_t * gNextDesc = NULL;
+static int gUnhandled = 0;
+static int gLate = 1;
+
+// -- Everything sent since the last clear, and the time it took
+static std::vector<uint32_t> gCapture;
+static bool gCapturing = true;
+static double gWireNs = 0;
+
+static uint32_t emulator_random(uint32_t range)
+{
+    gRandom = gRandom * 1103515245 + 12345;
+    return (gRandom >> 16) % range;
+}
+
+static i2s_dev_t * running_device()
+{
+    if (I2S0.conf.tx_start) return &I2S0;
+    if (I2S1.conf.tx_start) return &I2S1;
+    return NULL;
+}
+
+// -- Nanoseconds per I2S clock: the 80MHz base clock divided by
+//    div_num + div_b/div_a
+static double clock_ns(i2s_dev_t * dev)
+{
+    double div = dev->clkm_conf.clkm_div_num;
+    if (dev->clkm_conf.clkm_div_a) div += (double) dev->clkm_conf.clkm_div_b / dev->clkm_conf.clkm_div_a;
+    return div * 12.5;
+}
+
+static void handle_interrupt(i2s_dev_t * dev)
+{
+    dev->int_raw.out_eof = 1;
+    dev->int_st.out_eof = 1;
+    if (gHandler && gIntrEnabled && dev->int_ena.out_eof) {
+        gHandler(gHandlerArg);
+        gNumInterrupts++;
+    }
+    dev->int_st.out_eof = 0;
+}
+
+bool i2s_emulator_step(void)
+{
+    i2s_dev_t * dev = running_device();
+    if (dev == NULL) return false;
+
+    // -- A new transmission starts at out_link
+    if (dev->out_link.start) {
+        gNextDesc = (lldesc_t *) dev->out_link.addr;
+        dev->out_link.start = 0;
+        gUnhandled = 0;
+        gLate = 1 + emulator_random(gMaxLate);
+    }
+    if (gNextDesc == NULL) return false;
+
+    // -- Send the next buffer
+    lldesc_t * desc = gNextDesc;
+    const uint32_t * words = (const uint32_t *) desc->buf;
+    if (gCapturing) gCapture.insert(gCapture.end(), words, words + desc->length / 4);
+    gWireNs += (desc->length / 4) * clock_ns(dev);
+    dev->out_eof_des_addr = (uintptr_t) desc;
+    gNextDesc = desc->qe.stqe_next;
+
+    // -- The handler only sees the last buffer sent when it runs
+    gUnhandled++;
+    if (gUnhandled >= gLate) {
+        handle_interrupt(dev);
+        if (gDuplicates && emulator_random(3) == 0 && running_device()) {
+            handle_interrupt(dev);
+        }
+        gUnhandled = 0;
+        gLate = 1 + emulator_random(gMaxLate);
+    }
+    return true;
+}
+
+void i2s_emulator_set_interrupts(int max_late, bool duplicates)
+{
+    gMaxLate = (max_late < 1) ? 1 : max_late;
+    gDuplicates = duplicates;
+}
+
+void i2s_emulator_clear_capture(void)
+{
+    gCapture.clear();
+    gWireNs = 0;
+}
+
+void i2s_emulator_set_capture(bool on)
+{
+    gCapturing = on;
+}
+
+int i2s_emulator_get_capture(const uint32_t ** words)
+{
+    *words = gCapture.data();
+    return (int) gCapture.size();
+}
+
+int i2s_emulator_decode(int output, uint8_t * bytes, int max_bytes)
+{
+    // -- The length of every high pulse, in clocks
+    std::vector<int> highs;
+    int run = 0;
+    for (size_t i = 0; i < gCapture.size(); i++) {
+        if ((gCapture[i] >> output) & 1) {
+            run++;
+        } else if (run) {
+            highs.push_back(run);
+            run = 0;
+        }
+    }
+    if (run) highs.push_back(run);
+    if (highs.empty()) return 0;
+
+    int shortest = highs[0], longest = highs[0];
+    for (size_t i = 0; i < highs.size(); i++) {
+        if (highs[i] < shortest) shortest = highs[i];
+        if (highs[i] > longest) longest = highs[i];
+    }
+
+    int num_bytes = 0;
+    for (size_t i = 0; i + 8 <= highs.size() && num_bytes < max_bytes; i += 8) {
+        uint8_t byte = 0;
+        for (int b = 0; b < 8; b++) {
+            byte = (byte << 1) | ((2 * highs[i + b] > shortest + longest) ? 1 : 0);
+        }
+        bytes[num_bytes++] = byte;
+    }
+    return num_bytes;
+}
+
+uint64_t i2s_emulator_wire_ns(void)
+{
+    return (uint64_t) gWireNs;
+}
+
+uint32_t i2s_emulator_num_interrupts(void)
+{
+    return gNumInterrupts;
+}
+
+uint32_t i2s_emulator_cycles(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    return (uint32_t) (ns * (F_CPU / 1000000L) / 1000);
+}
+
+// -- Errors abort, like ESP_ERROR_CHECK does on the device
+void i2s_emulator_error_check(esp_err_t err, const char * expr)
+{
+    if (err != ESP_OK) {
+        fprintf(stderr, "i2s emulator: %s failed (%d)\n", expr, err);
+        abort();
+    }
+}
+
+// -- Heap
+
+void * heap_caps_malloc(size_t size, uint32_t)
+{
+    return malloc(size);
+}
+
+void * heap_caps_calloc(size_t n, size_t size, uint32_t)
+{
+    return calloc(n, size);
+}
+
+void heap_caps_free(void * ptr)
+{
+    free(ptr);
+}
+
+// -- GPIO, peripherals: nothing to do
+
+esp_err_t gpio_set_direction(gpio_num_t, gpio_mode_t)
+{
+    return ESP_OK;
+}
+
+void gpio_matrix_out(uint32_t, uint32_t, bool, bool)
+{
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void periph_module_enable(periph_module_t)
+{
+}
+
+// -- Interrupts
+
+esp_err_t esp_intr_alloc(int, int, intr_handler_t handler, void * arg, intr_handle_t * ret_handle)
+{
+    gHandler = handler;
+    gHandlerArg = arg;
+    gIntrEnabled = true;
+    if (ret_handle) *ret_handle = (intr_handle_t) &gHandler;
+    return ESP_OK;
+}
+
+esp_err_t esp_intr_enable(intr_handle_t)
+{
+    gIntrEnabled = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_intr_disable(intr_handle_t)
+{
+    gIntrEnabled = false;
+    return ESP_OK;
+}
+
+// -- Semaphores
+//    Waiting runs the DMA until someone gives the semaphore
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    SemaphoreHandle_t sem = (SemaphoreHandle_t) malloc(sizeof(struct i2s_emulator_sem));
+    sem->count = 0;
+    return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t)
+{
+    while (sem->count == 0) {
+        if ( ! i2s_emulator_step()) {
+            fprintf(stderr, "i2s emulator: waiting on a semaphore that nothing will give\n");
+            return pdFALSE;
+        }
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (sem->count >= 1) return pdFALSE;
+    sem->count++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t * woken)
+{
+    if (woken) *woken = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+
+#endif /* FASTLED_I2S_EMULATOR */
@@ -0,0 +1,280 @@
+/*
+ * Software model of the ESP32 I2S peripheral, for the host build
+ *
+ * With FASTLED_I2S_EMULATOR defined (along with FASTLED_HOST), the
+ * real I2S driver in platforms/esp/32/clockless_i2s_esp32.h is
+ * compiled for the host instead of the recording controller in
+ * clockless_host.h. This header stands in for the ESP-IDF headers it
+ * uses: the I2S registers, the DMA descriptors, and the few heap,
+ * GPIO, interrupt and FreeRTOS calls involved.
+ *
+ * The emulator plays the part of the DMA engine. Once the driver has
+ * started the transmission, it follows the descriptor ring from
+ * out_link, sends one buffer at a time, and raises the out_eof
+ * interrupt for it, calling the registered interrupt handler. The
+ * handler can be made to run late, after several buffers have gone
+ * out, and to run a second time for the same buffer, as it can on the
+ * device.
+ *
+ * Waiting on a semaphore runs the DMA until the semaphore is given, so
+ * FastLED.show() returns once the frame is out, as it does on the
+ * device. Everything sent is captured, one 32-bit word per I2S clock
+ * (bit n is parallel output n), and i2s_emulator_decode() turns a lane
+ * back into the bytes it carried. The time the frame takes on the wire
+ * is worked out from the clock dividers the driver set.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef BIT
+#define BIT(nr) (1UL << (nr))
+#endif
+
+// -- Errors
+typedef int esp_err_t;
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+void i2s_emulator_error_check(esp_err_t err, const char * expr);
+#define ESP_ERROR_CHECK(x) i2s_emulator_error_check((x), #x)
+
+// -- Heap: all memory is DMA capable
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+void * heap_caps_malloc(size_t size, uint32_t caps);
+void * heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void heap_caps_free(void * ptr);
+
+// -- GPIO and the GPIO matrix: nothing to route
+typedef int gpio_num_t;
+typedef enum { GPIO_MODE_DEF_OUTPUT = 2 } gpio_mode_t;
+
+#define PIN_FUNC_GPIO 2
+#define PIN_FUNC_SELECT(reg, func) do { (void)(reg); (void)(func); } while (0)
+extern const uint32_t GPIO_PIN_MUX_REG[];
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+void gpio_matrix_out(uint32_t gpio, uint32_t signal_idx, bool out_inv, bool oen_inv);
+
+#define OUTPUT 0x02
+void pinMode(uint8_t pin, uint8_t mode);
+
+// -- Peripherals
+typedef enum { PERIPH_I2S0_MODULE, PERIPH_I2S1_MODULE } periph_module_t;
+void periph_module_enable(periph_module_t periph);
+
+#define I2S0O_DATA_OUT0_IDX 140
+#define I2S1O_DATA_OUT0_IDX 166
+
+// -- DMA descriptor
+typedef struct lldesc_s {
+    volatile uint32_t size   :12,
+                      length :12,
+                      offset : 5,
+                      sosf   : 1,
+                      eof    : 1,
+                      owner  : 1;
+    volatile uint8_t * buf;
+    union {
+        volatile uint32_t empty;
+        struct {
+            struct lldesc_s * stqe_next;
+        } qe;
+    };
+} lldesc_t;
+
+// -- I2S registers (only the ones the driver touches)
+//    The descriptor addresses are whole pointers here, where the
+//    device has 32-bit addresses
+#define I2S_IN_RST_M            BIT(0)
+#define I2S_OUT_RST_M           BIT(1)
+#define I2S_AHBM_FIFO_RST_M     BIT(2)
+#define I2S_AHBM_RST_M          BIT(3)
+#define I2S_OUT_DATA_BURST_EN   BIT(9)
+#define I2S_OUTDSCR_BURST_EN    BIT(10)
+#define I2S_TX_RESET_M          BIT(0)
+#define I2S_RX_RESET_M          BIT(1)
+#define I2S_TX_FIFO_RESET_M     BIT(2)
+#define I2S_RX_FIFO_RESET_M     BIT(3)
+#define I2S_OUT_EOF_INT_ENA_V   1
+#define I2S_OUT_EOF_INT_ENA_S   12
+#define I2S_INT_ENA_REG(i)      (i)
+#define SET_PERI_REG_BITS(reg, bit_map, value, shift) \
+    do { (void)(reg); (void)(bit_map); (void)(value); (void)(shift); } while (0)
+
+typedef volatile struct i2s_dev_s {
+    union {
+        struct {
+            uint32_t tx_reset       :1;
+            uint32_t rx_reset       :1;
+            uint32_t tx_fifo_reset  :1;
+            uint32_t rx_fifo_reset  :1;
+            uint32_t tx_start       :1;
+            uint32_t rx_start       :1;
+            uint32_t tx_slave_mod   :1;
+            uint32_t rx_slave_mod   :1;
+            uint32_t tx_right_first :1;
+            uint32_t rx_right_first :1;
+            uint32_t tx_msb_shift   :1;
+            uint32_t rx_msb_shift   :1;
+            uint32_t tx_short_sync  :1;
+            uint32_t rx_short_sync  :1;
+            uint32_t tx_mono        :1;
+            uint32_t rx_mono        :1;
+            uint32_t tx_msb_right   :1;
+            uint32_t rx_msb_right   :1;
+        };
+        uint32_t val;
+    } conf;
+    union {
+        struct {
+            uint32_t out_eof       :1;
+            uint32_t out_dscr_err  :1;
+            uint32_t out_total_eof :1;
+        };
+        uint32_t val;
+    } int_raw, int_st, int_ena, int_clr;
+    union {
+        struct {
+            uint32_t in_rst  :1;
+            uint32_t out_rst :1;
+        };
+        uint32_t val;
+    } lc_conf;
+    struct {
+        uintptr_t addr;
+        uint32_t start;
+    } out_link;
+    union {
+        struct {
+            uint32_t lcd_en         :1;
+            uint32_t lcd_tx_wrx2_en :1;
+            uint32_t lcd_tx_sdx2_en :1;
+        };
+        uint32_t val;
+    } conf2;
+    union {
+        struct {
+            uint32_t tx_bits_mod    :6;
+            uint32_t tx_bck_div_num :6;
+        };
+        uint32_t val;
+    } sample_rate_conf;
+    union {
+        struct {
+            uint32_t clkm_div_num :8;
+            uint32_t clkm_div_b   :6;
+            uint32_t clkm_div_a   :6;
+            uint32_t clka_en      :1;
+        };
+        uint32_t val;
+    } clkm_conf;
+    union {
+        struct {
+            uint32_t tx_fifo_mod_force_en :1;
+            uint32_t tx_fifo_mod          :3;
+            uint32_t tx_data_num          :6;
+            uint32_t dscr_en              :1;
+        };
+        uint32_t val;
+    } fifo_conf;
+    union {
+        struct {
+            uint32_t tx_stop_en    :1;
+            uint32_t tx_pcm_bypass :1;
+        };
+        uint32_t val;
+    } conf1;
+    union {
+        struct {
+            uint32_t tx_chan_mod :3;
+        };
+        uint32_t val;
+    } conf_chan;
+    union {
+        uint32_t val;
+    } timing;
+    uintptr_t out_eof_des_addr;
+} i2s_dev_t;
+
+extern i2s_dev_t I2S0;
+extern i2s_dev_t I2S1;
+
+// -- Interrupts
+typedef void * intr_handle_t;
+typedef void (*intr_handler_t)(void * arg);
+#define ETS_I2S0_INTR_SOURCE   32
+#define ETS_I2S1_INTR_SOURCE   33
+
+esp_err_t esp_intr_alloc(int source, int flags, intr_handler_t handler, void * arg, intr_handle_t * ret_handle);
+esp_err_t esp_intr_enable(intr_handle_t handle);
+esp_err_t esp_intr_disable(intr_handle_t handle);
+
+// -- FreeRTOS, just enough for the driver
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef BaseType_t portBASE_TYPE;
+#define pdTRUE   1
+#define pdFALSE  0
+#define portMAX_DELAY ((TickType_t) 0xffffffffUL)
+
+typedef struct i2s_emulator_sem * SemaphoreHandle_t;
+typedef SemaphoreHandle_t xSemaphoreHandle;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t * woken);
+#define portYIELD_FROM_ISR() do { } while (0)
+
+// -- Emulator control
+
+// -- Interrupt timing
+//    Each out_eof interrupt is handled after between 1 and max_late
+//    buffers have gone out (1, the default, is right away). With
+//    duplicates set, the handler is sometimes called again for the
+//    same buffer, as happens when a second interrupt comes in while
+//    the first is being handled.
+void i2s_emulator_set_interrupts(int max_late, bool duplicates);
+
+// -- Send buffers until the driver stops the transmission or gives
+//    back the semaphore it waits on. Returns false if the DMA is not
+//    running.
+bool i2s_emulator_step(void);
+
+// -- Forget the words captured so far
+void i2s_emulator_clear_capture(void);
+
+// -- Turn capturing on (the default) or off. With it off the wire
+//    time is still counted, but the words are not kept, so that timing
+//    the driver does not also time the copy.
+void i2s_emulator_set_capture(bool on);
+
+// -- Words captured since the last clear, one per I2S clock
+//    Returns the number of words and points words at them
+int i2s_emulator_get_capture(const uint32_t ** words);
+
+// -- Decode the bytes sent on one parallel output (the controller's
+//    index plus 8) since the last clear. A bit is a one if its pulse
+//    stays high for longer than half way between the shortest and the
+//    longest high pulse seen on that output. Returns the number of
+//    bytes, at most max_bytes.
+int i2s_emulator_decode(int output, uint8_t * bytes, int max_bytes);
+
+// -- Time the words captured since the last clear took on the wire,
+//    in nanoseconds, at the clock rate the driver set
+uint64_t i2s_emulator_wire_ns(void);
+
+// -- Number of interrupts handled since the start
+uint32_t i2s_emulator_num_interrupts(void);
+
+// -- CPU cycle counter (what CCOUNT would read), from the host clock
+uint32_t i2s_emulator_cycles(void);
@@ -0,0 +1,57 @@
+#pragma once
+
+// -- Host (Linux) build
+//    There is no LED hardware: the clockless controller records the
+//    encoded bitstream in memory (see clockless_host.h). Used to build
+//    and measure the library and the effects off the device.
+
+#ifndef FASTLED_HOST
+#define FASTLED_HOST
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// -- Virtual CPU clock
+//    Clockless timings are given in CPU cycles, so use the ESP32 clock
+//    to get the same T1/T2/T3 values, and the same waveforms, as on
+//    the device.
+#ifndef F_CPU
+#define F_CPU 240000000L
+#endif
+
+// Use our own millis timer
+#define FASTLED_HAS_MILLIS
+
+typedef volatile uint32_t RoReg;
+typedef volatile uint32_t RwReg;
+typedef unsigned long prog_uint32_t;
+
+// Default to NOT using PROGMEM here
+#ifndef FASTLED_USE_PROGMEM
+# define FASTLED_USE_PROGMEM 0
+#endif
+
+#ifndef FASTLED_ALLOW_INTERRUPTS
+# define FASTLED_ALLOW_INTERRUPTS 1
+# define INTERRUPT_THRESHOLD 0
+#endif
+
+// -- No special memory on the host
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+#ifndef DRAM_ATTR
+#define DRAM_ATTR
+#endif
+
+// -- Time since start, from the monotonic clock
+//    (the same functions the ESP32 hal provides)
+unsigned long micros(void);
+unsigned long millis(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
@@ -0,0 +1,458 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+#ifdef FASTLED_RMT_EMULATOR
+
+#include <stdio.h>
+#include <stdlib.h>
+
+FASTLED_USING_NAMESPACE
+
+// -- The emulated peripheral
+rmt_mem_t RMTMEM;
+rmt_dev_t RMT;
+
+#define EMU_CHANNELS     8
+#define EMU_PINS         40
+#define EMU_BLOCK_ITEMS  64
+
+// -- State of one hardware channel
+typedef struct {
+    int      blocks;        // memory blocks, from rmt_config
+    int      clk_div;       // RMT clock divider, from rmt_config
+    int      pin;           // GPIO the channel drives, from rmt_set_pin
+    uint16_t tx_lim;        // threshold interrupt every tx_lim items
+    bool     thr_en;
+    bool     end_en;
+    bool     active;
+    bool     thr_due;       // threshold reached by the item going out
+    int      idx;           // next item to read, within the channel memory
+    uint32_t sent;          // items read since tx_start
+    uint64_t next_time;     // when the item going out is done
+} emu_channel_t;
+
+static emu_channel_t gChannels[EMU_CHANNELS];
+
+// -- Items captured per pin
+typedef struct {
+    uint32_t * items;
+    int        count;
+    int        capacity;
+    int        seg_start;   // first item of the last transmission
+    int        segments;    // transmissions since the last clear
+} emu_capture_t;
+
+static emu_capture_t gCapture[EMU_PINS];
+
+// -- Emulated time, in CPU cycles
+static uint64_t gNow = 0;
+
+// -- Interrupts raised and not yet cleared, and when the handler runs
+static uint32_t gRaw = 0;
+static bool     gIsrScheduled = false;
+static uint64_t gIsrTime = 0;
+static intr_handler_t gHandler = NULL;
+static void *   gHandlerArg = NULL;
+
+// -- Latency model
+static uint32_t gLatencyMin = 0;
+static uint32_t gLatencyMax = 0;
+static uint32_t gRandom = 0x2545F491;
+static uint32_t gNumInterrupts = 0;
+static uint32_t gMaxLatency = 0;
+
+struct rmt_emulator_sem {
+    int count;
+    int max;
+};
+
+// -- Item at position idx of a channel's memory, which runs on into
+//    the blocks of the following channels
+static volatile rmt_item32_t * emu_item(int channel, int idx)
+{
+    int pos = channel * EMU_BLOCK_ITEMS + idx;
+    return & RMTMEM.chan[pos / EMU_BLOCK_ITEMS].data32[pos % EMU_BLOCK_ITEMS];
+}
+
+// -- Next latency, uniform between the min and the max
+static uint32_t emu_latency()
+{
+    if (gLatencyMax <= gLatencyMin) return gLatencyMin;
+    gRandom ^= gRandom << 13;
+    gRandom ^= gRandom >> 17;
+    gRandom ^= gRandom << 5;
+    return gLatencyMin + (gRandom % (gLatencyMax - gLatencyMin + 1));
+}
+
+// -- Raise an interrupt; the handler runs after the latency
+static void emu_raise(uint32_t bit)
+{
+    gRaw |= bit;
+    if ( ! gIsrScheduled) {
+        uint32_t latency = emu_latency();
+        if (latency > gMaxLatency) gMaxLatency = latency;
+        gIsrTime = gNow + latency;
+        gIsrScheduled = true;
+    }
+}
+
+static void emu_capture(int pin, uint32_t item)
+{
+    if (pin < 0 || pin >= EMU_PINS) return;
+    emu_capture_t & cap = gCapture[pin];
+    if (cap.count == cap.capacity) {
+        cap.capacity = cap.capacity ? cap.capacity * 2 : 1024;
+        cap.items = (uint32_t *) realloc(cap.items, cap.capacity * sizeof(uint32_t));
+    }
+    cap.items[cap.count++] = item;
+}
+
+// -- Run the interrupt handler
+//    Whatever it did not clear is raised again
+static void emu_dispatch()
+{
+    if (gIsrTime > gNow) gNow = gIsrTime;
+    gIsrScheduled = false;
+    gNumInterrupts++;
+
+    RMT.int_st.val = gRaw;
+    RMT.int_clr.val = 0;
+    if (gHandler) gHandler(gHandlerArg);
+    uint32_t cleared = RMT.int_clr.val;
+    RMT.int_clr.val = 0;
+
+    uint32_t left = gRaw & ~cleared;
+    gRaw = 0;
+    RMT.int_st.val = 0;
+    if (left) emu_raise(left);
+}
+
+// -- The item going out on a channel is done: raise the threshold
+//    interrupt if it was due, and read the next one
+static void emu_next_item(int channel)
+{
+    emu_channel_t & ch = gChannels[channel];
+    gNow = ch.next_time;
+
+    if (ch.thr_due) {
+        ch.thr_due = false;
+        if (ch.thr_en) emu_raise(BIT(channel + 24));
+    }
+
+    rmt_item32_t item;
+    item.val = emu_item(channel, ch.idx)->val;
+
+    // -- A zero duration ends the transmission
+    if (item.duration0 == 0) {
+        ch.active = false;
+        if (ch.end_en) emu_raise(BIT(channel * 3));
+        return;
+    }
+
+    emu_capture(ch.pin, item.val);
+
+    uint32_t cycles_per_tick = (F_CPU / 80000000L) * ch.clk_div;
+    ch.next_time = gNow + (uint64_t) (item.duration0 + item.duration1) * cycles_per_tick;
+    ch.idx = (ch.idx + 1) % (ch.blocks * EMU_BLOCK_ITEMS);
+    ch.sent++;
+    if (ch.tx_lim && (ch.sent % ch.tx_lim) == 0) ch.thr_due = true;
+
+    if (item.duration1 == 0) {
+        // -- Ends after the first half of this item
+        ch.active = false;
+        if (ch.end_en) emu_raise(BIT(channel * 3));
+    }
+}
+
+bool rmt_emulator_step(void)
+{
+    int next = -1;
+    for (int c = 0; c < EMU_CHANNELS; c++) {
+        if (gChannels[c].active && (next < 0 || gChannels[c].next_time < gChannels[next].next_time)) {
+            next = c;
+        }
+    }
+
+    if (gIsrScheduled && (next < 0 || gIsrTime <= gChannels[next].next_time)) {
+        emu_dispatch();
+        return true;
+    }
+
+    if (next >= 0) {
+        emu_next_item(next);
+        return true;
+    }
+
+    return false;
+}
+
+void rmt_emulator_run(void)
+{
+    while (rmt_emulator_step()) ;
+}
+
+void rmt_emulator_set_latency(uint32_t min_cycles, uint32_t max_cycles)
+{
+    gLatencyMin = min_cycles;
+    gLatencyMax = max_cycles;
+}
+
+uint32_t rmt_emulator_cycles(void)
+{
+    return (uint32_t) gNow;
+}
+
+uint32_t rmt_emulator_num_interrupts(void)
+{
+    return gNumInterrupts;
+}
+
+uint32_t rmt_emulator_max_latency(void)
+{
+    return gMaxLatency;
+}
+
+void rmt_emulator_clear_capture(void)
+{
+    for (int pin = 0; pin < EMU_PINS; pin++) {
+        gCapture[pin].count = 0;
+        gCapture[pin].seg_start = 0;
+        gCapture[pin].segments = 0;
+    }
+    gNumInterrupts = 0;
+    gMaxLatency = 0;
+}
+
+int rmt_emulator_get_capture(int pin, const uint32_t ** items, int * segments)
+{
+    if (pin < 0 || pin >= EMU_PINS) return 0;
+    emu_capture_t & cap = gCapture[pin];
+    if (items) *items = cap.items + cap.seg_start;
+    if (segments) *segments = cap.segments;
+    return cap.count - cap.seg_start;
+}
+
+// -- Check the last transmission of every controller
+//    Low items (the reset sent before a retry) are skipped; every
+//    other item must be exactly the controller's one or zero item.
+int rmt_emulator_verify(bool verbose)
+{
+    int failed = 0;
+    for (int i = 0; i < ESP32RMTController::getNumControllers(); i++) {
+        ESP32RMTController * pController = ESP32RMTController::getController(i);
+
+        const uint32_t * items;
+        int segments;
+        int num_items = rmt_emulator_get_capture(pController->getPin(), &items, &segments);
+        if (segments == 0) continue;
+
+        const uint32_t * data = pController->getPixelData();
+        int num_bits = pController->getSize() * 32;
+        int bit = 0;
+        int bad = -1;
+        const char * why = "";
+        for (int n = 0; n < num_items && bad < 0; n++) {
+            rmt_item32_t item;
+            item.val = items[n];
+            if (item.level0 == 0) continue;
+
+            if (bit >= num_bits) {
+                bad = bit; why = "extra bits";
+                break;
+            }
+            bool expected = (data[bit / 32] >> (31 - (bit % 32))) & 1;
+            uint32_t want = expected ? pController->getOneItem() : pController->getZeroItem();
+            if (item.val != want) {
+                bad = bit; why = "wrong pulse";
+                break;
+            }
+            bit++;
+        }
+        if (bad < 0 && bit < num_bits) {
+            bad = bit; why = "missing bits";
+        }
+
+        if (bad >= 0) {
+            failed++;
+            if (verbose) {
+                printf("rmt emulator: controller %d (pin %d): %s at bit %d of %d (word %d), %d transmissions\n",
+                       i, pController->getPin(), why, bad, num_bits, bad / 32, segments);
+            }
+        }
+    }
+    return failed;
+}
+
+// -- Errors abort, like ESP_ERROR_CHECK does on the device
+void rmt_emulator_error_check(esp_err_t err, const char * expr)
+{
+    if (err != ESP_OK) {
+        fprintf(stderr, "rmt emulator: %s failed (%d)\n", expr, err);
+        abort();
+    }
+}
+
+// -- RMT driver calls
+
+esp_err_t rmt_config(const rmt_config_t * rmt_param)
+{
+    if (rmt_param->channel >= EMU_CHANNELS) return ESP_FAIL;
+    if (rmt_param->channel + rmt_param->mem_block_num > EMU_CHANNELS) return ESP_FAIL;
+    emu_channel_t & ch = gChannels[rmt_param->channel];
+    ch.blocks = rmt_param->mem_block_num;
+    ch.clk_div = rmt_param->clk_div;
+    ch.pin = rmt_param->gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t rmt_set_pin(rmt_channel_t channel, rmt_mode_t, gpio_num_t gpio_num)
+{
+    gChannels[channel].pin = gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t rmt_set_tx_thr_intr_en(rmt_channel_t channel, bool en, uint16_t evt_thresh)
+{
+    gChannels[channel].thr_en = en;
+    gChannels[channel].tx_lim = evt_thresh;
+    return ESP_OK;
+}
+
+esp_err_t rmt_set_tx_intr_en(rmt_channel_t channel, bool en)
+{
+    gChannels[channel].end_en = en;
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_start(rmt_channel_t channel, bool tx_idx_rst)
+{
+    emu_channel_t & ch = gChannels[channel];
+    if (tx_idx_rst) ch.idx = 0;
+    ch.sent = 0;
+    ch.thr_due = false;
+    ch.active = true;
+    ch.next_time = gNow;
+
+    if (ch.pin >= 0 && ch.pin < EMU_PINS) {
+        gCapture[ch.pin].seg_start = gCapture[ch.pin].count;
+        gCapture[ch.pin].segments++;
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t, size_t, int)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t rmt_translator_init(rmt_channel_t, sample_to_rmt_t)
+{
+    return ESP_FAIL;
+}
+
+esp_err_t rmt_write_sample(rmt_channel_t, const uint8_t *, size_t, bool)
+{
+    return ESP_FAIL;
+}
+
+void * rmt_register_tx_end_callback(rmt_tx_end_fn_t, void *)
+{
+    return NULL;
+}
+
+esp_err_t esp_intr_alloc(int, int, intr_handler_t handler, void * arg, intr_handle_t * ret_handle)
+{
+    gHandler = handler;
+    gHandlerArg = arg;
+    if (ret_handle) *ret_handle = (intr_handle_t) &gHandler;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t) (gNow / (F_CPU / 1000000L));
+}
+
+// -- Semaphores
+//    Waiting runs the emulator until someone gives the semaphore
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    SemaphoreHandle_t sem = (SemaphoreHandle_t) malloc(sizeof(struct rmt_emulator_sem));
+    sem->count = initial_count;
+    sem->max = max_count;
+    return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t)
+{
+    while (sem->count == 0) {
+        if ( ! rmt_emulator_step()) {
+            fprintf(stderr, "rmt emulator: waiting on a semaphore that nothing will give\n");
+            return pdFALSE;
+        }
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (sem->count >= sem->max) return pdFALSE;
+    sem->count++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t * woken)
+{
+    if (woken) *woken = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+
+// -- Never reached with a single core
+
+QueueHandle_t xQueueCreate(UBaseType_t, UBaseType_t)
+{
+    return NULL;
+}
+
+BaseType_t xQueueSend(QueueHandle_t, const void *, TickType_t)
+{
+    return pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t, void *, TickType_t)
+{
+    return pdFALSE;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *,
+                                   UBaseType_t, TaskHandle_t *, BaseType_t)
+{
+    return pdFALSE;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t)
+{
+    return 0;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    return 0;
+}
+
+void spi_flash_op_lock(void) { }
+void spi_flash_op_unlock(void) { }
+
+#endif /* FASTLED_RMT_EMULATOR */
@@ -0,0 +1,244 @@
+/*
+ * Software model of the ESP32 RMT peripheral, for the host build
+ *
+ * With FASTLED_RMT_EMULATOR defined (along with FASTLED_HOST), the
+ * real RMT driver in platforms/esp/32/clockless_rmt_esp32.cpp is
+ * compiled for the host instead of the recording controller in
+ * clockless_host.h. This header stands in for the ESP-IDF headers it
+ * uses: the RMTMEM memory blocks, the RMT interrupt status, clear
+ * and owner registers, and the few driver, interrupt and FreeRTOS
+ * calls involved.
+ *
+ * The emulator plays the part of the hardware. Each started channel
+ * reads items out of its memory blocks one at a time, wrapping at the
+ * end, and the time advances by the item durations. It raises the
+ * threshold interrupt each time another tx_lim items have gone out,
+ * and the end interrupt when it reads a zero item, and calls the
+ * registered interrupt handler after a configurable latency, during
+ * which the channels keep reading. Everything runs in emulated CPU
+ * cycles, which is also what __clock_cycles() and esp_timer_get_time()
+ * return, so the driver's timing checks see the emulated time.
+ *
+ * Waiting on a semaphore runs the emulator until the semaphore is
+ * given, so FastLED.show() returns once the frame is out, as it does
+ * on the device. Every item that goes out is captured per GPIO pin,
+ * and rmt_emulator_verify() decodes the last transmission on each
+ * controller's pin and compares it, bit for bit, with the pixel data
+ * the controller meant to send. For example, to find the interrupt
+ * latency a layout tolerates:
+ *
+ *     for (uint32_t latency = 0; latency < 20000; latency += 100) {
+ *         rmt_emulator_set_latency(latency, latency);
+ *         rmt_emulator_clear_capture();
+ *         FastLED.show();
+ *         if (rmt_emulator_verify(false) != 0) break;
+ *     }
+ *
+ * Only the custom driver is emulated, not FASTLED_RMT_BUILTIN_DRIVER.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// -- ESP-IDF version: 4.0 uses the plain rmt_* calls, which is all
+//    the emulator provides
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(4, 0, 0)
+
+#ifndef BIT
+#define BIT(nr) (1UL << (nr))
+#endif
+
+// -- Errors
+typedef int esp_err_t;
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+void rmt_emulator_error_check(esp_err_t err, const char * expr);
+#define ESP_ERROR_CHECK(x) rmt_emulator_error_check((x), #x)
+
+// -- GPIO
+typedef int gpio_num_t;
+
+// -- RMT items and memory
+typedef struct {
+    union {
+        struct {
+            uint32_t duration0 :15;
+            uint32_t level0 :1;
+            uint32_t duration1 :15;
+            uint32_t level1 :1;
+        };
+        uint32_t val;
+    };
+} rmt_item32_t;
+
+typedef struct {
+    struct {
+        volatile rmt_item32_t data32[64];
+    } chan[8];
+} rmt_mem_t;
+
+extern rmt_mem_t RMTMEM;
+
+// -- RMT registers (only the ones the driver touches)
+typedef struct {
+    struct {
+        struct {
+            volatile uint32_t mem_owner;
+        } conf1;
+    } conf_ch[8];
+    union {
+        volatile uint32_t val;
+    } int_st;
+    union {
+        volatile uint32_t val;
+    } int_clr;
+} rmt_dev_t;
+
+extern rmt_dev_t RMT;
+
+// -- RMT driver
+typedef enum {
+    RMT_CHANNEL_0 = 0, RMT_CHANNEL_1, RMT_CHANNEL_2, RMT_CHANNEL_3,
+    RMT_CHANNEL_4, RMT_CHANNEL_5, RMT_CHANNEL_6, RMT_CHANNEL_7,
+    RMT_CHANNEL_MAX
+} rmt_channel_t;
+
+typedef enum { RMT_MODE_TX = 0, RMT_MODE_RX } rmt_mode_t;
+typedef enum { RMT_CARRIER_LEVEL_LOW = 0, RMT_CARRIER_LEVEL_HIGH } rmt_carrier_level_t;
+typedef enum { RMT_IDLE_LEVEL_LOW = 0, RMT_IDLE_LEVEL_HIGH } rmt_idle_level_t;
+
+typedef struct {
+    bool loop_en;
+    uint32_t carrier_freq_hz;
+    uint8_t carrier_duty_percent;
+    rmt_carrier_level_t carrier_level;
+    bool carrier_en;
+    rmt_idle_level_t idle_level;
+    bool idle_output_en;
+} rmt_tx_config_t;
+
+typedef struct {
+    rmt_mode_t rmt_mode;
+    rmt_channel_t channel;
+    gpio_num_t gpio_num;
+    uint8_t clk_div;
+    uint8_t mem_block_num;
+    rmt_tx_config_t tx_config;
+} rmt_config_t;
+
+typedef void (*sample_to_rmt_t)(const void * src, rmt_item32_t * dest, size_t src_size,
+                                size_t wanted_num, size_t * translated_size, size_t * item_num);
+typedef void (*rmt_tx_end_fn_t)(rmt_channel_t channel, void * arg);
+
+esp_err_t rmt_config(const rmt_config_t * rmt_param);
+esp_err_t rmt_set_pin(rmt_channel_t channel, rmt_mode_t mode, gpio_num_t gpio_num);
+esp_err_t rmt_set_tx_thr_intr_en(rmt_channel_t channel, bool en, uint16_t evt_thresh);
+esp_err_t rmt_set_tx_intr_en(rmt_channel_t channel, bool en);
+esp_err_t rmt_tx_start(rmt_channel_t channel, bool tx_idx_rst);
+
+// -- Built-in driver: not emulated, these fail
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags);
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel);
+esp_err_t rmt_translator_init(rmt_channel_t channel, sample_to_rmt_t fn);
+esp_err_t rmt_write_sample(rmt_channel_t channel, const uint8_t * src, size_t src_size, bool wait_tx_done);
+void * rmt_register_tx_end_callback(rmt_tx_end_fn_t function, void * arg);
+
+// -- Interrupts
+typedef void * intr_handle_t;
+typedef void (*intr_handler_t)(void * arg);
+#define ETS_RMT_INTR_SOURCE    47
+#define ESP_INTR_FLAG_LEVEL3   (1 << 3)
+#define ESP_INTR_FLAG_IRAM     (1 << 10)
+
+esp_err_t esp_intr_alloc(int source, int flags, intr_handler_t handler, void * arg, intr_handle_t * ret_handle);
+
+// -- Time, in emulated microseconds
+int64_t esp_timer_get_time(void);
+
+// -- FreeRTOS, just enough for the driver
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef BaseType_t portBASE_TYPE;
+#define pdTRUE   1
+#define pdFALSE  0
+#define portMAX_DELAY ((TickType_t) 0xffffffffUL)
+#define portNUM_PROCESSORS 1
+
+typedef struct rmt_emulator_sem * SemaphoreHandle_t;
+typedef SemaphoreHandle_t xSemaphoreHandle;
+typedef struct rmt_emulator_queue * QueueHandle_t;
+typedef void * TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t * woken);
+#define portYIELD_FROM_ISR()         do { } while (0)
+
+// -- Only single core: the queue and task calls are never reached
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void * item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void * item, TickType_t ticks);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char * name, uint32_t stack, void * arg,
+                                   UBaseType_t priority, TaskHandle_t * handle, BaseType_t core);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+BaseType_t xPortGetCoreID(void);
+
+// -- No other core or interrupt can get in, so critical sections are empty
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux)      do { (void)(mux); } while (0)
+#define portEXIT_CRITICAL(mux)       do { (void)(mux); } while (0)
+#define portENTER_CRITICAL_ISR(mux)  do { (void)(mux); } while (0)
+#define portEXIT_CRITICAL_ISR(mux)   do { (void)(mux); } while (0)
+
+// -- Flash lock: nothing to lock
+void spi_flash_op_lock(void);
+void spi_flash_op_unlock(void);
+
+// -- Emulator control
+
+// -- Interrupt latency, in CPU cycles
+//    Each interrupt is handled a random number of cycles after it is
+//    raised, between min_cycles and max_cycles (inclusive)
+void rmt_emulator_set_latency(uint32_t min_cycles, uint32_t max_cycles);
+
+// -- Emulated CPU cycle counter (what CCOUNT would read)
+uint32_t rmt_emulator_cycles(void);
+
+// -- Advance to the next event: an item going out on a channel, or an
+//    interrupt being handled. Returns false if there is nothing left
+//    to do.
+bool rmt_emulator_step(void);
+
+// -- Run until all channels are idle and no interrupt is pending
+void rmt_emulator_run(void);
+
+// -- Forget the items captured so far
+void rmt_emulator_clear_capture(void);
+
+// -- Items captured on a pin since the last clear
+//    Returns the number of items in the last transmission on the pin
+//    (since the last tx_start) and points items at them. segments, if
+//    not NULL, receives the number of transmissions.
+int rmt_emulator_get_capture(int pin, const uint32_t ** items, int * segments);
+
+// -- Check the last transmission of every controller
+//    Decodes the items captured on each controller's pin and compares
+//    them with its pixel data. Returns the number of controllers whose
+//    data did not come out exactly; with verbose set, prints the first
+//    difference for each. Controllers that sent nothing since the last
+//    clear (skipped, or not shown) are not counted.
+int rmt_emulator_verify(bool verbose);
+
+// -- Number of interrupts handled, and the largest latency used
+uint32_t rmt_emulator_num_interrupts(void);
+uint32_t rmt_emulator_max_latency(void);
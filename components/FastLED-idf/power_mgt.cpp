@@ -26,6 +26,7 @@ static const uint8_t gRed_mW   = 16 * 5; // 16mA @ 5v = 80mW
 static const uint8_t gGreen_mW = 11 * 5; // 11mA @ 5v = 55mW
 static const uint8_t gBlue_mW  = 15 * 5; // 15mA @ 5v = 75mW
 static const uint8_t gDark_mW  =  1 * 5; //  1mA @ 5v =  5mW
+static const uint8_t gWhite_mW = 20 * 5; // 20mA @ 5v = 100mW, for the white led of an RGBW pixel
 
 // Alternate calibration by RAtkins via pre-PSU wattage measurments;
 // these are all probably about 20%-25% too high due to PSU heat losses,
@@ -47,15 +48,49 @@ static const uint8_t gMCU_mW  =  25 * 5; // 25mA @ 5v = 125 mW
 static uint8_t  gMaxPowerIndicatorLEDPinNumber = 0; // default = Arduino onboard LED pin.  set to zero to skip this.
 
 
-uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds ) //25354
+void calculate_channel_sums( const CRGB* ledbuffer, uint16_t numLeds, uint32_t sums[3])
 {
     uint32_t red32 = 0, green32 = 0, blue32 = 0;
-    const CRGB* firstled = &(ledbuffer[0]);
-    uint8_t* p = (uint8_t*)(firstled);
+    const uint8_t* p = (const uint8_t*)(ledbuffer);
 
     uint16_t count = numLeds;
 
-    // This loop might benefit from an AVR assembly version -MEK
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    // One led at a time until p is word aligned.  Each led moves p on by
+    // three bytes, so this takes at most three.
+    while( count && ((uintptr_t)p & 3)) {
+        red32   += *p++;
+        green32 += *p++;
+        blue32  += *p++;
+        count--;
+    }
+
+    // Then four leds (three words) at a time, adding the even and the odd
+    // bytes of each word into two 16-bit lanes.  A lane holds 256 bytes
+    // before it can overflow, so the lanes are emptied every 256 rounds.
+    typedef uint32_t __attribute__((__may_alias__)) word_t;
+    while( count >= 4) {
+        uint16_t rounds = (count / 4) > 256 ? 256 : (count / 4);
+        const word_t* w = (const word_t*)p;
+        count -= rounds * 4;
+        p += rounds * 12;
+
+        uint32_t lo0 = 0, hi0 = 0, lo1 = 0, hi1 = 0, lo2 = 0, hi2 = 0;
+        while( rounds--) {
+            uint32_t w0 = w[0], w1 = w[1], w2 = w[2];
+            w += 3;
+            lo0 += w0 & 0x00FF00FF; hi0 += (w0 >> 8) & 0x00FF00FF;
+            lo1 += w1 & 0x00FF00FF; hi1 += (w1 >> 8) & 0x00FF00FF;
+            lo2 += w2 & 0x00FF00FF; hi2 += (w2 >> 8) & 0x00FF00FF;
+        }
+
+        // The words hold r g b r / g b r g / b r g b, lowest byte first
+        red32   += (lo0 & 0xFFFF) + (hi0 >> 16) + (lo1 >> 16) + (hi2 & 0xFFFF);
+        green32 += (hi0 & 0xFFFF) + (lo1 & 0xFFFF) + (hi1 >> 16) + (lo2 >> 16);
+        blue32  += (lo0 >> 16) + (hi1 & 0xFFFF) + (lo2 & 0xFFFF) + (hi2 >> 16);
+    }
+#endif
+
     while( count) {
         red32   += *p++;
         green32 += *p++;
@@ -63,9 +98,85 @@ uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds )
         count--;
     }
 
-    red32   *= gRed_mW;
-    green32 *= gGreen_mW;
-    blue32  *= gBlue_mW;
+    sums[0] = red32;
+    sums[1] = green32;
+    sums[2] = blue32;
+}
+
+// Sums already taken this frame, so that every power limiter looking at a
+// buffer (FastLED's own, WS2812FX's) shares a single pass over it.  Emptied
+// by power_mgt_frame_done() once the frame has been shown.
+#ifndef POWER_SUMS_CACHE
+#define POWER_SUMS_CACHE 8
+#endif
+
+static struct {
+    const CRGB* leds;
+    uint16_t numLeds;
+    uint32_t sums[3];
+} gSumsCache[POWER_SUMS_CACHE];
+static uint8_t gSumsCached = 0;
+
+void get_channel_sums( const CRGB* ledbuffer, uint16_t numLeds, uint32_t sums[3])
+{
+    for( uint8_t i = 0; i < gSumsCached; i++) {
+        if( gSumsCache[i].leds == ledbuffer && gSumsCache[i].numLeds == numLeds) {
+            sums[0] = gSumsCache[i].sums[0];
+            sums[1] = gSumsCache[i].sums[1];
+            sums[2] = gSumsCache[i].sums[2];
+            return;
+        }
+    }
+
+    calculate_channel_sums( ledbuffer, numLeds, sums);
+
+    if( gSumsCached < POWER_SUMS_CACHE) {
+        gSumsCache[gSumsCached].leds = ledbuffer;
+        gSumsCache[gSumsCached].numLeds = numLeds;
+        gSumsCache[gSumsCached].sums[0] = sums[0];
+        gSumsCache[gSumsCached].sums[1] = sums[1];
+        gSumsCache[gSumsCached].sums[2] = sums[2];
+        gSumsCached++;
+    }
+}
+
+void power_mgt_frame_done()
+{
+    gSumsCached = 0;
+}
+
+static uint32_t unscaled_power_mW( const uint32_t sums[3], uint16_t numLeds)
+{
+    uint32_t red32   = (sums[0] * gRed_mW)   >> 8;
+    uint32_t green32 = (sums[1] * gGreen_mW) >> 8;
+    uint32_t blue32  = (sums[2] * gBlue_mW)  >> 8;
+
+    uint32_t total = red32 + green32 + blue32 + (gDark_mW * numLeds);
+
+    return total;
+}
+
+uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds ) //25354
+{
+    uint32_t sums[3];
+    calculate_channel_sums( ledbuffer, numLeds, sums);
+    return unscaled_power_mW( sums, numLeds);
+}
+
+uint32_t calculate_unscaled_power_mW( const CRGB16* ledbuffer, uint16_t numLeds )
+{
+    uint32_t red32 = 0, green32 = 0, blue32 = 0;
+
+    for( uint16_t i = 0; i < numLeds; i++) {
+        red32   += ledbuffer[i].r;
+        green32 += ledbuffer[i].g;
+        blue32  += ledbuffer[i].b;
+    }
+
+    // -- same as the 8-bit version, with 8 more bits of fraction
+    red32   = (red32   >> 8) * gRed_mW;
+    green32 = (green32 >> 8) * gGreen_mW;
+    blue32  = (blue32  >> 8) * gBlue_mW;
 
     red32   >>= 8;
     green32 >>= 8;
@@ -76,6 +187,52 @@ uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds )
     return total;
 }
 
+uint32_t calculate_unscaled_power_mW( const CRGBW* ledbuffer, uint16_t numLeds )
+{
+    uint32_t red32 = 0, green32 = 0, blue32 = 0, white32 = 0;
+    uint16_t count = numLeds;
+    const CRGBW* p = ledbuffer;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    // Every led is one aligned word: r and b go into the lanes of one
+    // accumulator, g and w into the other, emptied every 256 leds
+    while( count) {
+        uint16_t rounds = count > 256 ? 256 : count;
+        count -= rounds;
+
+        uint32_t rb = 0, gw = 0;
+        while( rounds--) {
+            uint32_t w = (p++)->raw32;
+            rb += w & 0x00FF00FF;
+            gw += (w >> 8) & 0x00FF00FF;
+        }
+
+        red32   += rb & 0xFFFF;
+        blue32  += rb >> 16;
+        green32 += gw & 0xFFFF;
+        white32 += gw >> 16;
+    }
+#else
+    while( count) {
+        red32   += p->r;
+        green32 += p->g;
+        blue32  += p->b;
+        white32 += p->w;
+        p++;
+        count--;
+    }
+#endif
+
+    red32   = (red32   * gRed_mW)   >> 8;
+    green32 = (green32 * gGreen_mW) >> 8;
+    blue32  = (blue32  * gBlue_mW)  >> 8;
+    white32 = (white32 * gWhite_mW) >> 8;
+
+    uint32_t total = red32 + green32 + blue32 + white32 + (gDark_mW * numLeds);
+
+    return total;
+}
+
 
 uint8_t calculate_max_brightness_for_power_vmA(const CRGB* ledbuffer, uint16_t numLeds, uint8_t target_brightness, uint32_t max_power_V, uint32_t max_power_mA) {
 	return calculate_max_brightness_for_power_mW(ledbuffer, numLeds, target_brightness, max_power_V * max_power_mA);
@@ -97,13 +254,28 @@ uint8_t calculate_max_brightness_for_power_mW(const CRGB* ledbuffer, uint16_t nu
 // sets brightness to
 //  - no more than target_brightness
 //  - no more than max_mW milliwatts
-uint8_t calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32_t max_power_mW)
+// taking the sums from get_channel_sums only when cached: the leds are
+// final only inside FastLED.show()
+static uint8_t max_brightness_for_power_mW( uint8_t target_brightness, uint32_t max_power_mW, bool cached)
 {
     uint32_t total_mW = gMCU_mW;
 
     CLEDController *pCur = CLEDController::head();
 	while(pCur) {
-        total_mW += calculate_unscaled_power_mW( pCur->leds(), pCur->size());
+        if( pCur->leds16()) {
+            total_mW += calculate_unscaled_power_mW( pCur->leds16(), pCur->size());
+        } else if( pCur->ledsW()) {
+            total_mW += calculate_unscaled_power_mW( pCur->ledsW(), pCur->size());
+        } else {
+            // the sums may already be known from another limiter this frame
+            uint32_t sums[3];
+            if( cached) {
+                get_channel_sums( pCur->leds(), pCur->size(), sums);
+            } else {
+                calculate_channel_sums( pCur->leds(), pCur->size(), sums);
+            }
+            total_mW += unscaled_power_mW( sums, pCur->size());
+        }
 		pCur = pCur->next();
 	}
 
@@ -155,6 +327,16 @@ uint8_t calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32
     return recommended_brightness;
 }
 
+uint8_t calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32_t max_power_mW)
+{
+    return max_brightness_for_power_mW( target_brightness, max_power_mW, false);
+}
+
+uint8_t show_max_brightness_for_power_mW( uint8_t target_brightness, uint32_t max_power_mW)
+{
+    return max_brightness_for_power_mW( target_brightness, max_power_mW, true);
+}
+
 
 void set_max_power_indicator_LED( uint8_t pinNumber)
 {
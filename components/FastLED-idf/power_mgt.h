@@ -53,11 +53,32 @@ void delay_at_max_brightness_for_power( uint16_t ms);
 
 // Power Control internal helper functions
 
+/// calculate_channel_sums adds up the red, green and blue values of a set of
+///   leds, a word at a time, into sums[0], sums[1] and sums[2].
+void calculate_channel_sums( const CRGB* ledbuffer, uint16_t numLeds, uint32_t sums[3]);
+
+/// get_channel_sums is calculate_channel_sums, but remembers the result until
+///   the end of the next FastLED.show() or showColor(), so that every power
+///   limiter looking at the same leds in a frame shares one pass over them.
+///   Call it once the frame's leds are final.
+void get_channel_sums( const CRGB* ledbuffer, uint16_t numLeds, uint32_t sums[3]);
+
+/// forget the sums get_channel_sums remembered (FastLED.show() calls this)
+void power_mgt_frame_done();
+
 /// calculate_unscaled_power_mW tells you how many milliwatts the current
-///   LED data would draw at brightness = 255.
+///   LED data would draw at brightness = 255.  It always adds up the leds
+///   afresh, as do the calculate_max_brightness_for_power functions; only
+///   FastLED.show()'s own power limiter uses get_channel_sums.
 ///
 uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds);
 
+/// the same, for 16-bit LED data
+uint32_t calculate_unscaled_power_mW( const CRGB16* ledbuffer, uint16_t numLeds);
+
+/// the same, for 4-byte rgbw LED data, counting the white channel too
+uint32_t calculate_unscaled_power_mW( const CRGBW* ledbuffer, uint16_t numLeds);
+
 /// calculate_max_brightness_for_power_mW tells you the highest brightness
 ///   level you can use and still stay under the specified power budget for 
 ///   a given set of leds.  It takes a pointer to an array of CRGB objects, a
@@ -81,6 +102,12 @@ uint8_t calculate_max_brightness_for_power_vmA(const CRGB* ledbuffer, uint16_t n
 ///   target_brightess you supply, but may be lower.
 uint8_t  calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32_t max_power_mW);
 
+/// the same, but sharing the sums other limiters took this frame through
+///   get_channel_sums.  This is the one FastLED.show() uses (see
+///   setMaxPowerInMilliWatts()); called any other time it may see sums from
+///   before the leds last changed.
+uint8_t  show_max_brightness_for_power_mW( uint8_t target_brightness, uint32_t max_power_mW);
+
 FASTLED_NAMESPACE_END
 ///@}
 // POWER_MGT_H
@@ -234,29 +234,29 @@ void WS2812FX::show(void) {
 
     uint32_t powerSum = 0;
 
-    for (uint16_t i = 0; i < _length; i++) //sum up the usage of each LED
+    if(useWackyWS2815PowerModel)
     {
-      CRGB c = _leds[i];
-
-      if(useWackyWS2815PowerModel)
+      for (uint16_t i = 0; i < _length; i++) //sum up the usage of each LED
       {
+        CRGB c = _leds[i];
         // ignore white component on WS2815 power calculation
         powerSum += (MAX(MAX(c.r,c.g),c.b)) * 3;
       }
-      else 
-      {
-        powerSum += (c.r + c.g + c.b) ;
-      }
     }
-
+    else
+    {
+      //the same sums FastLED's own power limit uses, so the leds are only read once a frame
+      uint32_t sums[3];
+      get_channel_sums(_leds, _length, sums);
+      powerSum = sums[0] + sums[1] + sums[2];
+    }
 
     uint32_t powerSum0 = powerSum;
     powerSum *= _brightness;
     
     if (powerSum > powerBudget) //scale brightness down to stay in current limit
     {
-      float scale = (float)powerBudget / (float)powerSum;
-      uint16_t scaleI = scale * 255;
+      uint32_t scaleI = ((uint64_t)powerBudget * 255) / powerSum;
       uint8_t scaleB = (scaleI > 255) ? 255 : scaleI;
       uint8_t newBri = scale8(_brightness, scaleB);
       FastLED.setBrightness(newBri);
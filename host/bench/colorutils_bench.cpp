@@ -0,0 +1,41 @@
+// Times the bulk functions in colorutils against the same work done one
+// led at a time, in nanoseconds per led.
+
+#include "FastLED.h"
+#include <stdio.h>
+#include <chrono>
+
+#define NUM_LEDS 1000
+#define ROUNDS 20000
+
+static CRGB gLeds[NUM_LEDS];
+static CRGB gOverlay[NUM_LEDS];
+
+static void nscale8Bulk(int k) { nscale8(gLeds, NUM_LEDS, 200 + (k & 31)); }
+static void nscale8Single(int k) { for (int i = 0; i < NUM_LEDS; i++) gLeds[i].nscale8(200 + (k & 31)); }
+static void videoBulk(int k) { nscale8_video(gLeds, NUM_LEDS, 200 + (k & 31)); }
+static void videoSingle(int k) { for (int i = 0; i < NUM_LEDS; i++) gLeds[i].nscale8_video(200 + (k & 31)); }
+static void nblendBulk(int k) { nblend(gLeds, gOverlay, NUM_LEDS, 100 + (k & 31)); }
+static void nblendSingle(int k) { for (int i = 0; i < NUM_LEDS; i++) nblend(gLeds[i], gOverlay[i], 100 + (k & 31)); }
+
+static void bench(const char *name, void (*fn)(int)) {
+    for (int i = 0; i < NUM_LEDS; i++) {
+        gLeds[i] = CRGB(i, i * 3, i * 7);
+        gOverlay[i] = CRGB(i * 5, 255 - i, i * 11);
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int k = 0; k < ROUNDS; k++) fn(k);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-24s %6.2f ns/led\n", name, ns / ROUNDS / NUM_LEDS);
+}
+
+int main() {
+    bench("nscale8", nscale8Bulk);
+    bench("nscale8, per led", nscale8Single);
+    bench("nscale8_video", videoBulk);
+    bench("nscale8_video, per led", videoSingle);
+    bench("nblend", nblendBulk);
+    bench("nblend, per led", nblendSingle);
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Times the I2S driver on the emulated peripheral: the CPU time
+// FastLED.show() spends loading, transposing and encoding each pixel
+// row, and the time the frame then takes on the wire (its makespan),
+// for 8, 16 and 24 strips of equal length and for one long strip with
+// short ones (where the schedule drops finished strips).
+//
+// The CPU time is in TSC ticks on x86 and nanoseconds elsewhere; it
+// measures the host, not the ESP32, so compare runs with each other.
+
+#include "FastLED.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "ticks"
+static uint64_t now() { return __rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+#define MAX_STRIPS 24
+#define NUM_LEDS 256
+#define SHORT_LEDS 16
+#define ROUNDS 300
+
+static CRGB gLeds[MAX_STRIPS][NUM_LEDS];
+
+// -- Strips beyond the first num_strips get no leds
+static void bench(int num_strips, bool ragged) {
+    for (int s = 0; s < MAX_STRIPS; s++) {
+        int n = 0;
+        if (s < num_strips) n = (ragged && s > 0) ? SHORT_LEDS : NUM_LEDS;
+        FastLED[s].setLeds(gLeds[s], n);
+    }
+    FastLED.show();
+
+    uint64_t best = ~0ULL;
+    for (int r = 0; r < ROUNDS; r++) {
+        i2s_emulator_clear_capture();
+        uint64_t start = now();
+        FastLED.show();
+        uint64_t t = now() - start;
+        if (t < best) best = t;
+    }
+
+    // -- A row is 24 bit times; every strip sends its bit in the same one
+    printf("%2d strips%s  %7.1f %s/row  %5.2f %s/bit  makespan %7.1f us\n",
+           num_strips, ragged ? ", 1 long + short" : "               ",
+           (double) best / NUM_LEDS, BENCH_UNIT,
+           (double) best / (NUM_LEDS * 24), BENCH_UNIT,
+           i2s_emulator_wire_ns() / 1000.0);
+}
+
+int main() {
+    // -- There are only 22 output pins; the last two strips share pins
+    //    (a different color order makes them separate controllers)
+    FastLED.addLeds<WS2812B, 0, GRB>(gLeds[0], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 1, GRB>(gLeds[1], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 2, GRB>(gLeds[2], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 3, GRB>(gLeds[3], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 4, GRB>(gLeds[4], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 5, GRB>(gLeds[5], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 12, GRB>(gLeds[6], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 13, GRB>(gLeds[7], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 14, GRB>(gLeds[8], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 15, GRB>(gLeds[9], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 16, GRB>(gLeds[10], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 17, GRB>(gLeds[11], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 18, GRB>(gLeds[12], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 19, GRB>(gLeds[13], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 21, GRB>(gLeds[14], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 22, GRB>(gLeds[15], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 23, GRB>(gLeds[16], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 25, GRB>(gLeds[17], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 26, GRB>(gLeds[18], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 27, GRB>(gLeds[19], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 32, GRB>(gLeds[20], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 33, GRB>(gLeds[21], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 32, RGB>(gLeds[22], NUM_LEDS);
+    FastLED.addLeds<WS2812B, 33, RGB>(gLeds[23], NUM_LEDS);
+
+    srand(3);
+    for (int s = 0; s < MAX_STRIPS; s++) {
+        for (int i = 0; i < NUM_LEDS; i++) gLeds[s][i] = CRGB(rand(), rand(), rand());
+    }
+    FastLED.setBrightness(200);
+    // -- Time the driver, not the refresh rate cap
+    FastLED.setMaxRefreshRate(0);
+    i2s_emulator_set_capture(false);
+
+    bench(8, false);
+    bench(16, false);
+    bench(24, false);
+    bench(8, true);
+    bench(24, true);
+    return 0;
+}
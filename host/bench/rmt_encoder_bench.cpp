@@ -0,0 +1,107 @@
+// Times the two ways the RMT driver has turned pixel words into RMT
+// items in fillNext(): one item per bit, picked with a branch, and four
+// items per lookup in the nibble table. Both loops are copies of the
+// driver's, writing one half of a channel's memory (PULSES_PER_FILL
+// items, two words) per call through a volatile pointer, as they do on
+// the device. Reports nanoseconds per 32-bit pixel word.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+
+#define PULSES_PER_FILL 64
+#define NUM_WORDS 4096
+#define ROUNDS 2000
+
+// -- WS2812 items at the RMT's 40MHz: duration0, level0, duration1, level1
+#define RMT_ITEM(d0, l0, d1, l1) ((uint32_t) (d0) | ((uint32_t) (l0) << 15) | ((uint32_t) (d1) << 16) | ((uint32_t) (l1) << 31))
+
+static const uint32_t gOne = RMT_ITEM(32, 1, 18, 0);
+static const uint32_t gZero = RMT_ITEM(16, 1, 34, 0);
+
+static uint32_t gNibbleItems[16][4];
+static uint32_t gPixelData[NUM_WORDS];
+static volatile uint32_t gRMTMem[PULSES_PER_FILL];
+
+// -- One item per bit (fillNext() before the nibble table)
+__attribute__ ((noinline)) static void fillPerBit(int cur)
+{
+    uint32_t one_val = gOne;
+    uint32_t zero_val = gZero;
+    volatile uint32_t * pItem = gRMTMem;
+    for (int i = 0; i < PULSES_PER_FILL / 32; i++) {
+        uint32_t thispixel = gPixelData[cur + i];
+        for (int j = 0; j < 32; j++) {
+            *pItem++ = (thispixel & 0x80000000L) ? one_val : zero_val;
+            thispixel <<= 1;
+        }
+    }
+}
+
+// -- Four items per lookup (fillNext() now)
+__attribute__ ((noinline)) static void fillNibble(int cur)
+{
+    volatile uint32_t * pItem = gRMTMem;
+    for (int i = 0; i < PULSES_PER_FILL / 32; i++) {
+        uint32_t thispixel = gPixelData[cur + i];
+        for (int j = 0; j < 8; j++) {
+            const uint32_t * items = gNibbleItems[thispixel >> 28];
+            pItem[0] = items[0];
+            pItem[1] = items[1];
+            pItem[2] = items[2];
+            pItem[3] = items[3];
+            pItem += 4;
+            thispixel <<= 4;
+        }
+    }
+}
+
+static void bench(const char * name, void (*fill)(int))
+{
+    double best = 1e30;
+    for (int r = 0; r < 5; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int k = 0; k < ROUNDS; k++) {
+            for (int cur = 0; cur < NUM_WORDS; cur += PULSES_PER_FILL / 32) fill(cur);
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (ns < best) best = ns;
+    }
+    printf("%-12s %6.2f ns/word\n", name, best / ROUNDS / NUM_WORDS);
+}
+
+// -- Both loops must write the same items
+static bool same()
+{
+    uint32_t perbit[PULSES_PER_FILL];
+    for (int cur = 0; cur < NUM_WORDS; cur += PULSES_PER_FILL / 32) {
+        fillPerBit(cur);
+        for (int i = 0; i < PULSES_PER_FILL; i++) perbit[i] = gRMTMem[i];
+        fillNibble(cur);
+        for (int i = 0; i < PULSES_PER_FILL; i++) {
+            if (perbit[i] != gRMTMem[i]) return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    for (int n = 0; n < 16; n++) {
+        for (int bit = 0; bit < 4; bit++) {
+            gNibbleItems[n][bit] = (n & (0x8 >> bit)) ? gOne : gZero;
+        }
+    }
+    srand(5);
+    for (int i = 0; i < NUM_WORDS; i++) gPixelData[i] = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+
+    if ( ! same()) {
+        printf("the encoders disagree\n");
+        return 1;
+    }
+    bench("per bit", fillPerBit);
+    bench("nibble table", fillNibble);
+    return 0;
+}
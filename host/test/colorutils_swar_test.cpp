@@ -0,0 +1,127 @@
+// Checks that the word-at-a-time (SWAR) bulk functions in colorutils give
+// exactly what the per-led versions give, for every alignment of the led
+// arrays.  Exits non-zero on the first few mismatches.
+
+#include "FastLED.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LEDS 300
+
+static uint8_t gBulk[3 * MAX_LEDS + 8];
+static uint8_t gRef[3 * MAX_LEDS + 8];
+static uint8_t gOverlay[3 * MAX_LEDS + 8];
+static int gFailures = 0;
+
+static void fail(const char *what, int offset, int n, int amount) {
+    if (gFailures < 10) {
+        printf("FAIL %s: offset %d, %d leds, amount %d\n", what, offset, n, amount);
+    }
+    gFailures++;
+}
+
+// -- Random arrays, random alignment, random amounts (with 0 and 255 often)
+static void testRandom() {
+    srand(1);
+    for (int t = 0; t < 20000; t++) {
+        int offset = rand() % 4;
+        int overlay_offset = rand() % 4;
+        int n = rand() % MAX_LEDS;
+        uint8_t amount = rand();
+        if (t % 7 == 0) amount = 0;
+        if (t % 11 == 0) amount = 255;
+
+        for (size_t i = 0; i < sizeof(gBulk); i++) {
+            gBulk[i] = (rand() % 5 == 0) ? 0 : rand();
+            gOverlay[i] = rand();
+        }
+        memcpy(gRef, gBulk, sizeof(gBulk));
+        CRGB *bulk = (CRGB *)(gBulk + offset);
+        CRGB *ref = (CRGB *)(gRef + offset);
+        CRGB *overlay = (CRGB *)(gOverlay + overlay_offset);
+
+        const char *what;
+        switch (t % 3) {
+        case 0:
+            what = "nscale8";
+            nscale8(bulk, n, amount);
+            for (int i = 0; i < n; i++) ref[i].nscale8(amount);
+            break;
+        case 1:
+            what = "nscale8_video";
+            nscale8_video(bulk, n, amount);
+            for (int i = 0; i < n; i++) ref[i].nscale8_video(amount);
+            break;
+        default:
+            what = "nblend";
+            nblend(bulk, overlay, n, amount);
+            for (int i = 0; i < n; i++) nblend(ref[i], overlay[i], amount);
+            break;
+        }
+        if (memcmp(gBulk, gRef, sizeof(gBulk))) fail(what, offset, n, amount);
+    }
+}
+
+// -- The same for CRGBW, which is always whole words
+static void testRandomRgbw() {
+    static CRGBW bulk[MAX_LEDS], ref[MAX_LEDS], overlay[MAX_LEDS];
+    srand(2);
+    for (int t = 0; t < 20000; t++) {
+        int n = rand() % MAX_LEDS;
+        uint8_t amount = rand();
+        if (t % 7 == 0) amount = 0;
+        if (t % 11 == 0) amount = 255;
+
+        for (int i = 0; i < n; i++) {
+            bulk[i].raw32 = ((uint32_t)rand() << 16) ^ rand();
+            if (rand() % 5 == 0) bulk[i].w = 0;
+            overlay[i].raw32 = ((uint32_t)rand() << 16) ^ rand();
+        }
+        memcpy(ref, bulk, sizeof(bulk));
+
+        const char *what;
+        switch (t % 3) {
+        case 0:
+            what = "nscale8 (rgbw)";
+            nscale8(bulk, n, amount);
+            for (int i = 0; i < n; i++) ref[i].nscale8(amount);
+            break;
+        case 1:
+            what = "nscale8_video (rgbw)";
+            nscale8_video(bulk, n, amount);
+            for (int i = 0; i < n; i++) ref[i].nscale8_video(amount);
+            break;
+        default:
+            what = "nblend (rgbw)";
+            nblend(bulk, overlay, n, amount);
+            for (int i = 0; i < n; i++) nblend(ref[i], overlay[i], amount);
+            break;
+        }
+        if (memcmp(bulk, ref, n * sizeof(CRGBW))) fail(what, 0, n, amount);
+    }
+}
+
+// -- Every pair of bytes, blended by every amount
+static void testBlendAllPairs() {
+    const int n = 65536 / 3 + 1;
+    static CRGB existing[n], ref[n], overlay[n];
+    for (int amount = 0; amount < 256; amount++) {
+        for (int i = 0; i < 3 * n; i++) {
+            ((uint8_t *)existing)[i] = i & 0xFF;
+            ((uint8_t *)overlay)[i] = (i >> 8) & 0xFF;
+        }
+        for (int i = 0; i < n; i++) ref[i] = existing[i];
+        nblend(existing, overlay, n, amount);
+        for (int i = 0; i < n; i++) nblend(ref[i], overlay[i], amount);
+        if (memcmp(existing, ref, sizeof(ref))) fail("nblend, all pairs", 0, n, amount);
+    }
+}
+
+int main() {
+    testRandom();
+    testRandomRgbw();
+    testBlendAllPairs();
+    printf("colorutils_swar_test: %d failures\n", gFailures);
+    return gFailures ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+// Runs the I2S driver on the emulated peripheral and checks that every
+// strip gets exactly its pixel bytes: strips of different lengths and
+// chipsets, with the interrupt handler on time, late, and called twice,
+// and with a strip switched to RGBW after the first frames. Exits
+// non-zero on a mismatch.
+
+#include "FastLED.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_STRIPS 4
+
+static const int gLengths[NUM_STRIPS] = { 37, 5, 20, 12 };
+static CRGB gLeds[NUM_STRIPS][37];
+static int gFailures = 0;
+
+// -- Bytes in the order each chipset sends them, four per led for an
+//    RGBW strip: the color less the white, then the white
+static void expected(int strip, uint8_t * bytes) {
+    int rgbw = FastLED[strip].isRgbw();
+    int step = rgbw ? 4 : 3;
+    for (int i = 0; i < gLengths[strip]; i++) {
+        const CRGB & c = gLeds[strip][i];
+        uint8_t * b = bytes + step * i;
+        if (strip == 3) {
+            // WS2811, RGB
+            b[0] = c.r; b[1] = c.g; b[2] = c.b;
+            if (rgbw) b[3] = FastLED[strip].getWhite().extract(b[0], b[1], b[2], 0, 1, 2);
+        } else {
+            // WS2812B, GRB
+            b[0] = c.g; b[1] = c.r; b[2] = c.b;
+            if (rgbw) b[3] = FastLED[strip].getWhite().extract(b[0], b[1], b[2], 1, 0, 2);
+        }
+    }
+}
+
+static void checkFrame(const char * what, int frame) {
+    for (int s = 0; s < NUM_STRIPS; s++) {
+        for (int i = 0; i < gLengths[s]; i++) gLeds[s][i] = CRGB(rand(), rand(), rand());
+        // -- Ones and zeros in every byte of the first led, so that each
+        //    lane has both short and long pulses to tell apart
+        gLeds[s][0] = CRGB(0x0f, 0xf0, 0x5a);
+    }
+
+    i2s_emulator_clear_capture();
+    FastLED.show();
+
+    // -- Every lane runs as long as the longest strip; a shorter strip
+    //    is followed by zeros, which no led sees
+    for (int s = 0; s < NUM_STRIPS; s++) {
+        uint8_t want[4 * 37];
+        uint8_t got[4 * 37 + 8];
+        int num_bytes = (FastLED[s].isRgbw() ? 4 : 3) * 37;
+        memset(want, 0, sizeof(want));
+        expected(s, want);
+        int n = i2s_emulator_decode(s + 8, got, sizeof(got));
+        if (n != num_bytes || memcmp(want, got, n) != 0) {
+            if (gFailures < 10) {
+                printf("FAIL %s: frame %d, strip %d: %d bytes decoded, %d expected%s\n",
+                       what, frame, s, n, num_bytes, (n == num_bytes) ? ", contents differ" : "");
+            }
+            gFailures++;
+        }
+    }
+}
+
+int main() {
+    FastLED.addLeds<WS2812B, 0, GRB>(gLeds[0], gLengths[0]);
+    FastLED.addLeds<WS2812B, 1, GRB>(gLeds[1], gLengths[1]);
+    FastLED.addLeds<WS2812B, 2, GRB>(gLeds[2], gLengths[2]);
+    FastLED.addLeds<WS2811, 3, RGB>(gLeds[3], gLengths[3]);
+    FastLED.setBrightness(255);
+    FastLED.setDither(DISABLE_DITHER);
+    srand(7);
+
+    i2s_emulator_set_interrupts(1, false);
+    for (int f = 0; f < 20; f++) checkFrame("on time", f);
+
+    i2s_emulator_set_interrupts(3, false);
+    for (int f = 0; f < 20; f++) checkFrame("late", f);
+
+    i2s_emulator_set_interrupts(3, true);
+    for (int f = 0; f < 20; f++) checkFrame("late and duplicated", f);
+
+    // -- Four bytes per led on the longest strip: the frame and the DMA
+    //    buffers grow, and shrink again when it goes back to RGB
+    i2s_emulator_set_interrupts(1, false);
+    FastLED[0].setRgbw();
+    for (int f = 0; f < 5; f++) checkFrame("RGBW after RGB", f);
+    FastLED[0].setRgb();
+    for (int f = 0; f < 5; f++) checkFrame("RGB after RGBW", f);
+
+    if (gFailures) {
+        printf("%d failures\n", gFailures);
+        return 1;
+    }
+    printf("ok (%u interrupts)\n", (unsigned) i2s_emulator_num_interrupts());
+    return 0;
+}
@@ -0,0 +1,192 @@
+// Runs the RMT driver on the emulated peripheral and checks that every
+// strip gets exactly its pixel data: strips of different lengths, CRGB,
+// CRGBW and CRGB16 data, several memory block layouts, asynchronous
+// show, and strips that change length or go to RGBW between frames. For
+// each layout it also prints the highest interrupt latency the frame
+// survives. Exits non-zero on a mismatch.
+//
+// Built twice: with the driver's defaults, and with frame retries and
+// skipping of unchanged strips turned on.
+
+#include "FastLED.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_LATENCY 40000
+#define LATENCY_STEP 500
+
+static CRGB gA[300];
+static CRGB gB[100];
+static CRGBW gC[37];
+static CRGB16 gD[50];
+static int gFailures = 0;
+
+static void change() {
+    for (int i = 0; i < 300; i++) gA[i] = CRGB(rand(), rand(), rand());
+    for (int i = 0; i < 100; i++) gB[i] = CRGB(rand(), rand(), rand());
+    for (int i = 0; i < 37; i++) gC[i] = CRGBW(rand(), rand(), rand(), rand());
+    for (int i = 0; i < 50; i++) gD[i] = CRGB16(rand(), rand(), rand());
+}
+
+static void check(const char * what) {
+    if (rmt_emulator_verify(gFailures < 10) != 0) {
+        printf("FAIL %s\n", what);
+        gFailures++;
+    }
+}
+
+static void show(const char * what) {
+    change();
+    rmt_emulator_clear_capture();
+    FastLED.show();
+    check(what);
+}
+
+// -- The frame a controller sends must be as long as its leds need
+static void checkSize(const char * what, int controller, int words) {
+    int size = ESP32RMTController::getController(controller)->getSize();
+    if (size != words) {
+        printf("FAIL %s: controller %d sends %d words, %d expected\n", what, controller, size, words);
+        gFailures++;
+    }
+}
+
+// -- Highest latency, in steps of LATENCY_STEP, at which every frame
+//    still comes out right
+static uint32_t latencyTolerated() {
+    uint32_t tolerated = 0;
+    for (uint32_t latency = 0; latency <= MAX_LATENCY; latency += LATENCY_STEP) {
+        rmt_emulator_set_latency(latency, latency);
+        change();
+        rmt_emulator_clear_capture();
+        FastLED.show();
+        if (rmt_emulator_verify(false) != 0) break;
+        tolerated = latency;
+    }
+    rmt_emulator_set_latency(0, 0);
+    return tolerated;
+}
+
+static void layout(const char * name, int a, int b, int c, int d) {
+    ESP32RMTController::getController(0)->setMemBlocks(a);
+    ESP32RMTController::getController(1)->setMemBlocks(b);
+    ESP32RMTController::getController(2)->setMemBlocks(c);
+    ESP32RMTController::getController(3)->setMemBlocks(d);
+    for (int f = 0; f < 5; f++) show(name);
+    uint32_t tolerated = latencyTolerated();
+    printf("memory blocks %-8s latency tolerated %5u cycles%s\n", name, (unsigned) tolerated,
+           (tolerated == MAX_LATENCY) ? " (the most tried)" : "");
+    // -- Whatever the last frame of the sweep did, the next one is whole
+    show(name);
+}
+
+int main() {
+    FastLED.addLeds<WS2812, 12, GRB>(gA, 300);
+    FastLED.addLeds<WS2812, 13, GRB>(gB, 100);
+    FastLED.addLeds<SK6812, 14, GRB>(gC, 37).setRgbw();
+    FastLED.addLeds<WS2812, 15, GRB>(gD, 50);
+    FastLED.setBrightness(255);
+    srand(11);
+
+    layout("2,2,2,2", 2, 2, 2, 2);
+    layout("4,1,2,1", 4, 1, 2, 1);
+    layout("1,1,1,1", 1, 1, 1, 1);
+    layout("8,8,8,8", 8, 8, 8, 8);
+    layout("2,2,2,2", 2, 2, 2, 2);
+
+    // -- Asynchronous show: the frame goes out while the next is loaded
+    for (int f = 0; f < 5; f++) {
+        change();
+        FastLED.waitForShow();
+        rmt_emulator_clear_capture();
+        FastLED.showAsync();
+        FastLED.waitForShow();
+        check("async");
+    }
+    change();
+    rmt_emulator_clear_capture();
+    FastLED.showAsync();
+    change();
+    FastLED.showAsync();
+    FastLED.waitForShow();
+    check("async, back to back");
+
+    // -- Four bytes per led after the first show: the buffers grow, in
+    //    both synchronous and asynchronous show, and shrink back
+    FastLED[1].setRgbw();
+    show("RGBW after RGB");
+    checkSize("RGBW after RGB", 1, 100);
+    for (int f = 0; f < 3; f++) {
+        change();
+        rmt_emulator_clear_capture();
+        FastLED.showAsync();
+        FastLED.waitForShow();
+        check("RGBW after RGB, async");
+    }
+    checkSize("RGBW after RGB, async", 1, 100);
+    FastLED[1].setRgb();
+    show("RGB after RGBW");
+    checkSize("RGB after RGBW", 1, 75);
+
+    // -- A strip that gets shorter, then longer again
+    FastLED[0].setLeds(gA, 200);
+    show("shorter strip");
+    checkSize("shorter strip", 0, 150);
+    FastLED[0].setLeds(gA, 300);
+    FastLED.showAsync();
+    FastLED.waitForShow();
+    show("longer strip");
+    checkSize("longer strip", 0, 225);
+
+#if FASTLED_RMT_MAX_RETRIES > 0
+    // -- Latency that sometimes cuts a frame short: the retry resends it
+    uint32_t retries = 0;
+    for (int i = 0; i < 4; i++) retries += ESP32RMTController::getController(i)->getRetries();
+    int whole = 0;
+    rmt_emulator_set_latency(0, 16000);
+    for (int f = 0; f < 20; f++) {
+        change();
+        rmt_emulator_clear_capture();
+        FastLED.show();
+        if (rmt_emulator_verify(false) == 0) whole++;
+    }
+    rmt_emulator_set_latency(0, 0);
+    uint32_t retried = 0;
+    for (int i = 0; i < 4; i++) retried += ESP32RMTController::getController(i)->getRetries();
+    printf("latency up to 16000 cycles: %u strips retried, %d of 20 frames whole\n", (unsigned) (retried - retries), whole);
+    // -- A retried frame must not be skipped next time, even unchanged
+    rmt_emulator_clear_capture();
+    FastLED.show();
+    check("after retries");
+#endif
+
+#if FASTLED_RMT_SKIP_UNCHANGED
+    // -- The same frame again: nothing is sent, and the next change is.
+    //    Dithering must be off, and the 16-bit strip must have no
+    //    fraction to dither, or the data changes every frame.
+    FastLED.setDither(0);
+    change();
+    for (int i = 0; i < 50; i++) gD[i] = CRGB16(gD[i].r & 0xFF00, gD[i].g & 0xFF00, gD[i].b & 0xFF00);
+    rmt_emulator_clear_capture();
+    FastLED.show();
+    check("before skipping");
+    uint32_t skips = 0;
+    for (int i = 0; i < 4; i++) skips -= ESP32RMTController::getController(i)->getSkips();
+    rmt_emulator_clear_capture();
+    FastLED.show();
+    for (int i = 0; i < 4; i++) skips += ESP32RMTController::getController(i)->getSkips();
+    check("unchanged");
+    if (skips != 4) {
+        printf("FAIL unchanged: %u of 4 strips skipped\n", (unsigned) skips);
+        gFailures++;
+    }
+    show("after skipping");
+#endif
+
+    if (gFailures) {
+        printf("%d failures\n", gFailures);
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}